@@ -0,0 +1,201 @@
+#include "Bench.h"
+
+#include "CrossWindow/CrossWindow.h"
+#include "CrossWindow/Common/EventRecording.h"
+
+#include <stdio.h>
+
+/**
+ * Steady state zero allocation checks. Each check runs a frame loop long
+ * enough for every queue to reach its working depth, then counts heap
+ * allocations over many more frames of update(), front() and pop(). Any
+ * allocation fails the check.
+ */
+using namespace xwin;
+using namespace xwin::bench;
+
+namespace
+{
+const unsigned sWarmupFrames = 300;
+const unsigned sMeasuredFrames = 3000;
+
+template <typename Loop> bool check(const char* name, Loop loop)
+{
+    loop(sWarmupFrames);
+
+    uint64_t news = getAllocationCount();
+    uint64_t mallocs = getMallocCount();
+    uint64_t events = loop(sMeasuredFrames);
+    news = getAllocationCount() - news;
+    mallocs = getMallocCount() - mallocs;
+
+    bool passed = news == 0 && mallocs == 0;
+    printf("  %-32s %s  %llu events, %llu new, %llu malloc\n", name,
+           passed ? "PASS" : "FAIL", static_cast<unsigned long long>(events),
+           static_cast<unsigned long long>(news),
+           static_cast<unsigned long long>(mallocs));
+    fflush(stdout);
+    return passed;
+}
+
+uint64_t drain(EventQueue& eventQueue)
+{
+    uint64_t events = 0;
+    while (!eventQueue.empty())
+    {
+        doNotOptimize(eventQueue.front());
+        eventQueue.pop();
+        ++events;
+    }
+    return events;
+}
+
+#if defined(XWIN_NOOP)
+bool checkHeadless()
+{
+    EventQueue eventQueue;
+    Window window;
+    WindowDesc desc;
+    desc.width = 1280;
+    desc.height = 720;
+    window.create(desc, eventQueue);
+
+    SyntheticInput input(42);
+    input.setWindow(&window);
+    input.addMouseMotion(1000.0);
+    input.addKeyStorm(30.0, 4);
+    input.addResizeSweep(20.0, UVec2(320, 240), UVec2(1920, 1080), 2.0);
+    input.addGamepadNoise(250.0, 6, 0.3);
+    eventQueue.setSyntheticInput(&input);
+
+    bool passed = check("headless synthetic frame loop", [&](unsigned frames) {
+        uint64_t events = 0;
+        for (unsigned f = 0; f < frames; ++f)
+        {
+            eventQueue.update();
+            events += drain(eventQueue);
+
+            const WindowDesc& current = window.getDesc();
+            doNotOptimize(current.width);
+            doNotOptimize(window.getWindowSize());
+        }
+        return events;
+    });
+    eventQueue.setSyntheticInput(nullptr);
+
+    // Record a session of the same input and play it back in a loop.
+    const char* path = "crosswindow-alloccheck.xwev";
+    {
+        EventQueue recordQueue;
+        SyntheticInput recordInput(7);
+        recordInput.addMouseMotion(1000.0);
+        recordInput.addKeyStorm(30.0, 4);
+        recordInput.addGamepadNoise(250.0, 6, 0.3);
+        recordQueue.setSyntheticInput(&recordInput);
+
+        EventRecorder recorder;
+        if (!recorder.open(path))
+        {
+            printf("  could not write %s\n", path);
+            return false;
+        }
+        for (unsigned f = 0; f < 600; ++f)
+        {
+            recordQueue.update();
+            while (!recordQueue.empty())
+            {
+                recorder.record(recordQueue.front(), f * 16667ull);
+                recordQueue.pop();
+            }
+            recorder.markFrame(f * 16667ull);
+        }
+    }
+
+    EventPlayback playback;
+    bool opened = playback.open(path);
+    remove(path);
+    if (!opened)
+    {
+        printf("  could not read %s\n", path);
+        return false;
+    }
+    playback.setMode(EventPlayback::Mode::AsFastAsPossible);
+    eventQueue.setPlayback(&playback);
+
+    passed &= check("headless playback frame loop", [&](unsigned frames) {
+        uint64_t events = 0;
+        for (unsigned f = 0; f < frames; ++f)
+        {
+            if (playback.finished())
+            {
+                playback.restart();
+            }
+            eventQueue.update();
+            events += drain(eventQueue);
+        }
+        return events;
+    });
+    eventQueue.setPlayback(nullptr);
+    return passed;
+}
+#endif
+
+#if defined(XWIN_XCB)
+bool checkXcb()
+{
+    EventQueue eventQueue;
+
+    xcb_motion_notify_event_t motion = {};
+    motion.response_type = XCB_MOTION_NOTIFY;
+    xcb_key_press_event_t key = {};
+    key.response_type = XCB_KEY_PRESS;
+    key.detail = 0x41;
+    xcb_button_press_event_t button = {};
+    button.response_type = XCB_BUTTON_PRESS;
+    button.state = XCB_BUTTON_MASK_1 | XCB_BUTTON_MASK_3;
+    xcb_expose_event_t expose = {};
+    expose.response_type = XCB_EXPOSE;
+    xcb_configure_notify_event_t configure = {};
+    configure.response_type = XCB_CONFIGURE_NOTIFY;
+
+    return check("xcb decode frame loop", [&](unsigned frames) {
+        uint64_t events = 0;
+        for (unsigned f = 0; f < frames; ++f)
+        {
+            // A frame's worth of mixed input, decoded without a server since
+            // libxcb's own per event malloc is outside our control.
+            for (unsigned i = 0; i < 32; ++i)
+            {
+                motion.event_x = static_cast<int16_t>(i + f);
+                eventQueue.pushEvent((xcb_generic_event_t*)&motion);
+            }
+            eventQueue.pushEvent((xcb_generic_event_t*)&key);
+            eventQueue.pushEvent((xcb_generic_event_t*)&button);
+            eventQueue.pushEvent((xcb_generic_event_t*)&expose);
+            eventQueue.pushEvent((xcb_generic_event_t*)&configure);
+            events += drain(eventQueue);
+        }
+        return events;
+    });
+}
+#endif
+}
+
+namespace xwin
+{
+namespace bench
+{
+bool runAllocationChecks()
+{
+    printf("Steady state allocation checks\n");
+    bool passed = true;
+#if defined(XWIN_NOOP)
+    passed &= checkHeadless();
+#elif defined(XWIN_XCB)
+    passed &= checkXcb();
+#endif
+    printf("%s\n", passed ? "All checks passed." : "Allocation checks failed.");
+    return passed;
+}
+}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * A tiny self contained benchmark harness for CrossWindow's hot paths.
+ *
+ * Each benchmark is a function that runs its body a given number of
+ * iterations, the harness scales the iteration count until a run takes long
+ * enough to time, then reports nanoseconds and heap allocations per op.
+ */
+namespace xwin
+{
+namespace bench
+{
+struct Result
+{
+    double nsPerOp = 0.0;
+    double allocsPerOp = 0.0;
+    uint64_t iterations = 0;
+};
+
+typedef void (*BenchFunction)(uint64_t iterations);
+
+// Number of calls to the global operator new since startup.
+uint64_t getAllocationCount();
+
+// Number of calls to malloc/calloc/realloc since startup, which includes
+// operator new. Always 0 where malloc can't be interposed.
+uint64_t getMallocCount();
+
+// Check the steady state frame loop of each backend doesn't allocate,
+// returns false and prints the offenders if it does.
+bool runAllocationChecks();
+
+// Run a benchmark body, scaling the iterations until it's timeable.
+Result run(BenchFunction function);
+
+// Print a result row, groups are printed once as a header.
+void report(const char* group, const char* name, const Result& result);
+
+// Register a benchmark, returns true so it can initialize a static.
+bool add(const char* group, const char* name, BenchFunction function);
+
+// Keep the optimizer from removing the computation that produced a value.
+template <typename T> inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+inline uint64_t nowNs()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+}
+}
+
+#define XWIN_BENCH_CONCAT_(a, b) a##b
+#define XWIN_BENCH_CONCAT(a, b) XWIN_BENCH_CONCAT_(a, b)
+
+// Define a benchmark body, `iterations` is the number of ops to run.
+#define XWIN_BENCHMARK(group, name)                                            \
+    static void XWIN_BENCH_CONCAT(bench_, name)(uint64_t iterations);          \
+    static const bool XWIN_BENCH_CONCAT(registered_, name) =                   \
+        xwin::bench::add(group, #name, &XWIN_BENCH_CONCAT(bench_, name));      \
+    static void XWIN_BENCH_CONCAT(bench_, name)(uint64_t iterations)
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "CrossWindow/Common/EventQueue.h"
+
+/**
+ * Backend neutral ways to push a representative event into an EventQueue.
+ * XCB goes through the real decoder with a synthetic X event so no server is
+ * needed.
+ */
+namespace xwin
+{
+namespace bench
+{
+inline void pushMouseMove(EventQueue& eventQueue, unsigned i)
+{
+#if defined(XWIN_XCB)
+    xcb_motion_notify_event_t motion = {};
+    motion.response_type = XCB_MOTION_NOTIFY;
+    motion.event_x = static_cast<int16_t>(i & 0x7fff);
+    motion.event_y = static_cast<int16_t>((i >> 3) & 0x7fff);
+    eventQueue.pushEvent(reinterpret_cast<xcb_generic_event_t*>(&motion));
+#else
+    eventQueue.pushEvent(
+        Event(MouseMoveData(i & 0x7fff, (i >> 3) & 0x7fff, 0, 0, 1, 1)));
+#endif
+}
+
+inline void pushFocus(EventQueue& eventQueue)
+{
+#if defined(XWIN_XCB)
+    xcb_enter_notify_event_t enter = {};
+    enter.response_type = XCB_ENTER_NOTIFY;
+    eventQueue.pushEvent(reinterpret_cast<xcb_generic_event_t*>(&enter));
+#else
+    eventQueue.pushEvent(Event(FocusData(true)));
+#endif
+}
+}
+}
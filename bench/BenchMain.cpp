@@ -0,0 +1,177 @@
+#include "Bench.h"
+
+#include <atomic>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GLIBC__)
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* p, size_t size);
+}
+#endif
+
+namespace
+{
+std::atomic<uint64_t> sAllocations(0);
+std::atomic<uint64_t> sMallocs(0);
+
+// Minimum time a measured run should take to be trusted.
+const uint64_t sMinRunNs = 50 * 1000 * 1000;
+
+struct Entry
+{
+    const char* group;
+    const char* name;
+    xwin::bench::BenchFunction function;
+};
+
+std::vector<Entry>& getRegistry()
+{
+    static std::vector<Entry> registry;
+    return registry;
+}
+}
+
+#if defined(__GLIBC__)
+// Count C allocations too, glibc lets the executable interpose malloc.
+extern "C" void* malloc(size_t size)
+{
+    sMallocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+    sMallocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* p, size_t size)
+{
+    sMallocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(p, size);
+}
+#endif
+
+void* operator new(size_t size)
+{
+    sAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void* p) noexcept { free(p); }
+
+void operator delete[](void* p) noexcept { free(p); }
+
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+namespace xwin
+{
+namespace bench
+{
+uint64_t getAllocationCount()
+{
+    return sAllocations.load(std::memory_order_relaxed);
+}
+
+uint64_t getMallocCount() { return sMallocs.load(std::memory_order_relaxed); }
+
+Result run(BenchFunction function)
+{
+    // Warm up caches and any lazily grown storage.
+    function(1000);
+
+    Result result;
+    uint64_t iterations = 1000;
+    for (;;)
+    {
+        uint64_t allocations = getAllocationCount();
+        uint64_t start = nowNs();
+        function(iterations);
+        uint64_t elapsed = nowNs() - start;
+        allocations = getAllocationCount() - allocations;
+
+        if (elapsed >= sMinRunNs || iterations >= (1ull << 34))
+        {
+            result.iterations = iterations;
+            result.nsPerOp = static_cast<double>(elapsed) / iterations;
+            result.allocsPerOp = static_cast<double>(allocations) / iterations;
+            return result;
+        }
+        uint64_t scale = elapsed > 0 ? (sMinRunNs * 3 / 2) / elapsed : 100;
+        iterations *= scale < 2 ? 2 : (scale > 100 ? 100 : scale);
+    }
+}
+
+void report(const char* group, const char* name, const Result& result)
+{
+    static std::string lastGroup;
+    if (lastGroup != group)
+    {
+        lastGroup = group;
+        printf("\n%s\n", group);
+        printf("  %-40s %12s %12s %14s\n", "benchmark", "ns/op", "allocs/op",
+               "iterations");
+    }
+    printf("  %-40s %12.2f %12.3f %14llu\n", name, result.nsPerOp,
+           result.allocsPerOp,
+           static_cast<unsigned long long>(result.iterations));
+    fflush(stdout);
+}
+
+bool add(const char* group, const char* name, BenchFunction function)
+{
+    Entry entry = {group, name, function};
+    getRegistry().push_back(entry);
+    return true;
+}
+}
+}
+
+int main(int argc, const char** argv)
+{
+    const char* filter = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--check-allocations") == 0)
+        {
+            return xwin::bench::runAllocationChecks() ? 0 : 1;
+        }
+        else
+        {
+            printf("usage: %s [--filter substring] [--check-allocations]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+
+    for (const Entry& entry : getRegistry())
+    {
+        std::string fullName = std::string(entry.group) + "/" + entry.name;
+        if (filter != nullptr && fullName.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        xwin::bench::report(entry.group, entry.name,
+                            xwin::bench::run(entry.function));
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "Bench.h"
+
+#include "CrossWindow/Common/Event.h"
+
+using namespace xwin;
+using namespace xwin::bench;
+
+namespace
+{
+const char* sGroup = "Event construction/copy";
+
+template <typename T> void constructEvent(uint64_t iterations, const T& data)
+{
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        Event e(data);
+        doNotOptimize(e);
+    }
+}
+
+void copyEvent(uint64_t iterations, const Event& source)
+{
+    Event e;
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        e = source;
+        doNotOptimize(e);
+    }
+}
+
+TouchData makeTouch()
+{
+    TouchData t = {};
+    t.numTouches = 2;
+    return t;
+}
+
+GamepadData makeGamepad()
+{
+    GamepadData g = {};
+    g.connected = true;
+    g.numAxes = 4;
+    g.numButtons = 16;
+    return g;
+}
+}
+
+XWIN_BENCHMARK(sGroup, construct_Focus)
+{
+    constructEvent(iterations, FocusData(true));
+}
+
+XWIN_BENCHMARK(sGroup, construct_Resize)
+{
+    constructEvent(iterations, ResizeData(1280, 720, false));
+}
+
+XWIN_BENCHMARK(sGroup, construct_Keyboard)
+{
+    constructEvent(iterations,
+                   KeyboardData(Key::A, ButtonState::Pressed, ModifierState()));
+}
+
+XWIN_BENCHMARK(sGroup, construct_MouseMove)
+{
+    constructEvent(iterations, MouseMoveData(1, 2, 3, 4, 5, 6));
+}
+
+XWIN_BENCHMARK(sGroup, construct_MouseInput)
+{
+    constructEvent(iterations, MouseInputData(MouseInput::Left,
+                                              ButtonState::Pressed,
+                                              ModifierState()));
+}
+
+XWIN_BENCHMARK(sGroup, construct_Touch)
+{
+    constructEvent(iterations, makeTouch());
+}
+
+XWIN_BENCHMARK(sGroup, construct_Gamepad)
+{
+    constructEvent(iterations, makeGamepad());
+}
+
+XWIN_BENCHMARK(sGroup, copy_MouseMove)
+{
+    copyEvent(iterations, Event(MouseMoveData(1, 2, 3, 4, 5, 6)));
+}
+
+XWIN_BENCHMARK(sGroup, copy_Touch) { copyEvent(iterations, Event(makeTouch())); }
+
+XWIN_BENCHMARK(sGroup, copy_Gamepad)
+{
+    copyEvent(iterations, Event(makeGamepad()));
+}
@@ -0,0 +1,180 @@
+#include "Bench.h"
+#include "BenchEvents.h"
+
+#include <vector>
+
+using namespace xwin;
+using namespace xwin::bench;
+
+namespace
+{
+const char* sGroup = "EventQueue push/pop";
+
+// Fill the queue to Depth then drain it, ops are push + pop pairs.
+template <unsigned Depth> void fillDrain(uint64_t iterations)
+{
+    EventQueue eventQueue;
+    uint64_t done = 0;
+    while (done < iterations)
+    {
+        for (unsigned i = 0; i < Depth; ++i)
+        {
+            pushMouseMove(eventQueue, i);
+        }
+        while (!eventQueue.empty())
+        {
+            doNotOptimize(eventQueue.front());
+            eventQueue.pop();
+        }
+        done += Depth;
+    }
+}
+
+// Keep Depth events queued and time one push + pop at that depth, the cost
+// a consumer that's Depth events behind pays per event.
+template <unsigned Depth> void steadyState(uint64_t iterations)
+{
+    EventQueue eventQueue;
+    for (unsigned i = 0; i < Depth; ++i)
+    {
+        pushMouseMove(eventQueue, i);
+    }
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        pushMouseMove(eventQueue, static_cast<unsigned>(i));
+        doNotOptimize(eventQueue.front());
+        eventQueue.pop();
+    }
+}
+
+// Keep Depth mouse moves queued, then time how long a Focus event pushed
+// behind them takes to reach the consumer. Popped moves are pushed back so the
+// flood never drains.
+template <DrainOrder Order, unsigned Depth> void flood(uint64_t iterations)
+{
+    EventQueue eventQueue;
+    eventQueue.setDrainOrder(Order);
+    for (unsigned i = 0; i < Depth; ++i)
+    {
+        pushMouseMove(eventQueue, i);
+    }
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        pushFocus(eventQueue);
+        while (eventQueue.front().type != EventType::Focus)
+        {
+            eventQueue.pop();
+            pushMouseMove(eventQueue, static_cast<unsigned>(i));
+        }
+        doNotOptimize(eventQueue.front());
+        eventQueue.pop();
+    }
+}
+
+// A consumer stall: Burst mouse moves arrive before the consumer drains the
+// queue, bounded to Capacity events (0 is unbounded). One op is a whole
+// burst plus the drain, the time to catch up after the stall.
+template <unsigned Capacity, unsigned Burst> void stall(uint64_t iterations)
+{
+    EventQueue eventQueue;
+    eventQueue.setCapacity(Capacity);
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        for (unsigned j = 0; j < Burst; ++j)
+        {
+            pushMouseMove(eventQueue, j);
+        }
+        while (!eventQueue.empty())
+        {
+            doNotOptimize(eventQueue.front());
+            eventQueue.pop();
+        }
+    }
+}
+
+// Four subsystems that each need every event, fed by copying the queue into
+// a vector per subsystem. One op is one event delivered to all four.
+void copyToConsumers(uint64_t iterations)
+{
+    EventQueue eventQueue;
+    std::vector<Event> consumers[4];
+    uint64_t done = 0;
+    while (done < iterations)
+    {
+        for (unsigned i = 0; i < 64; ++i)
+        {
+            pushMouseMove(eventQueue, i);
+        }
+        while (!eventQueue.empty())
+        {
+            for (std::vector<Event>& consumer : consumers)
+            {
+                consumer.push_back(eventQueue.front());
+            }
+            eventQueue.pop();
+        }
+        for (std::vector<Event>& consumer : consumers)
+        {
+            for (const Event& e : consumer)
+            {
+                doNotOptimize(e);
+            }
+            consumer.clear();
+        }
+        done += 64;
+    }
+}
+
+// The same four subsystems each reading a broadcast ring through their own
+// cursor.
+void broadcastToConsumers(uint64_t iterations)
+{
+    EventQueue eventQueue;
+    EventBroadcast broadcast(256);
+    eventQueue.setBroadcast(&broadcast);
+    EventBroadcast::Consumer consumers[4];
+    for (EventBroadcast::Consumer& consumer : consumers)
+    {
+        consumer = broadcast.addConsumer();
+    }
+    uint64_t done = 0;
+    while (done < iterations)
+    {
+        for (unsigned i = 0; i < 64; ++i)
+        {
+            pushMouseMove(eventQueue, i);
+        }
+        for (EventBroadcast::Consumer consumer : consumers)
+        {
+            while (const Event* e = broadcast.peek(consumer))
+            {
+                doNotOptimize(*e);
+                broadcast.advance(consumer);
+            }
+        }
+        done += 64;
+    }
+}
+
+const bool sRegistered =
+    add(sGroup, "fill_drain/depth_1", &fillDrain<1>) &&
+    add(sGroup, "fill_drain/depth_16", &fillDrain<16>) &&
+    add(sGroup, "fill_drain/depth_256", &fillDrain<256>) &&
+    add(sGroup, "fill_drain/depth_4096", &fillDrain<4096>) &&
+    add(sGroup, "steady/depth_0", &steadyState<0>) &&
+    add(sGroup, "steady/depth_16", &steadyState<16>) &&
+    add(sGroup, "steady/depth_256", &steadyState<256>) &&
+    add(sGroup, "steady/depth_4096", &steadyState<4096>) &&
+    add(sGroup, "flood/arrival/depth_256",
+        &flood<DrainOrder::Arrival, 256>) &&
+    add(sGroup, "flood/priority/depth_256",
+        &flood<DrainOrder::Priority, 256>) &&
+    add(sGroup, "flood/arrival/depth_4096",
+        &flood<DrainOrder::Arrival, 4096>) &&
+    add(sGroup, "flood/priority/depth_4096",
+        &flood<DrainOrder::Priority, 4096>) &&
+    add(sGroup, "stall/unbounded/burst_16384", &stall<0, 16384>) &&
+    add(sGroup, "stall/capacity_256/burst_16384", &stall<256, 16384>) &&
+    add(sGroup, "consumers_4/copy", &copyToConsumers) &&
+    add(sGroup, "consumers_4/broadcast", &broadcastToConsumers);
+}
@@ -0,0 +1,441 @@
+#include "Bench.h"
+#include "Xvfb.h"
+
+#include "CrossWindow/CrossWindow.h"
+
+#include <xcb/xtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+/**
+ * End to end input latency of the XCB backend.
+ *
+ * A second connection injects pointer motion or key presses with XTEST at a
+ * fixed rate, and each is timed from injection until it reaches
+ * EventQueue::front(). This covers the X server, the socket, xcb and our
+ * decode path, with no hardware involved.
+ */
+using namespace xwin;
+using namespace xwin::bench;
+
+namespace
+{
+enum class Mode
+{
+    Poll,
+    Wait,
+    Threaded,
+    ModeMax
+};
+
+const char* sModeNames[] = {"poll", "wait", "threaded"};
+
+enum class Input
+{
+    Motion,
+    Key
+};
+
+struct Options
+{
+    bool useDisplay = false;
+    bool sweep = false;
+    unsigned events = 2000;
+    double rate = 1000.0;
+    int mode = -1;
+    Input input = Input::Motion;
+};
+
+struct Stats
+{
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+    double achievedRate = 0.0;
+    unsigned lost = 0;
+};
+
+// Grace period for in flight events once injection is done.
+const unsigned sDrainMs = 100;
+
+// Stop sweeping here even if the path keeps up.
+const double sMaxRate = 1024000.0;
+
+// Key code 0x41 is the space bar on every X keymap we decode.
+const uint8_t sKeyCode = 0x41;
+
+struct Context
+{
+    xcb_connection_t* injector;
+    xcb_window_t root;
+    xcb_window_t target;
+    unsigned width;
+    EventQueue* eventQueue;
+};
+
+bool isMeasured(const Event& e, Input input)
+{
+    if (input == Input::Motion)
+    {
+        return e.type == EventType::MouseMove;
+    }
+    return e.type == EventType::Keyboard &&
+           e.data.keyboard.state == ButtonState::Pressed;
+}
+
+void inject(const Context& ctx, Input input, unsigned i)
+{
+    if (input == Input::Motion)
+    {
+        // Consecutive positions always differ so no motion is dropped.
+        int16_t x = static_cast<int16_t>(1 + i % (ctx.width - 2));
+        int16_t y = static_cast<int16_t>(100 + (i / (ctx.width - 2)) % 100);
+        xcb_test_fake_input(ctx.injector, XCB_MOTION_NOTIFY, 0,
+                            XCB_CURRENT_TIME, ctx.root, x, y, 0);
+    }
+    else
+    {
+        xcb_test_fake_input(ctx.injector, XCB_KEY_PRESS, sKeyCode,
+                            XCB_CURRENT_TIME, XCB_NONE, 0, 0, 0);
+        xcb_test_fake_input(ctx.injector, XCB_KEY_RELEASE, sKeyCode,
+                            XCB_CURRENT_TIME, XCB_NONE, 0, 0, 0);
+    }
+    xcb_flush(ctx.injector);
+}
+
+// Wake a consumer blocked in xcb_wait_for_event.
+void wake(const Context& ctx)
+{
+    xcb_client_message_event_t message = {};
+    message.response_type = XCB_CLIENT_MESSAGE;
+    message.format = 32;
+    message.window = ctx.target;
+    xcb_send_event(ctx.injector, 0, ctx.target, XCB_EVENT_MASK_NO_EVENT,
+                   reinterpret_cast<const char*>(&message));
+    xcb_flush(ctx.injector);
+}
+
+Stats runTrial(const Context& ctx, Mode mode, Input input, double rate,
+               unsigned count)
+{
+    std::vector<uint64_t> sent(count, 0);
+    std::vector<uint64_t> received(count, 0);
+    std::atomic<bool> done(false);
+    unsigned numReceived = 0;
+
+    EventQueue& eventQueue = *ctx.eventQueue;
+    eventQueue.setProcessingMode(mode == Mode::Poll
+                                     ? EventQueue::ProcessingMode::Poll
+                                     : EventQueue::ProcessingMode::Wait);
+
+    // Drop anything left over from the previous trial.
+    while (!eventQueue.empty())
+    {
+        eventQueue.pop();
+    }
+
+    uint64_t period = static_cast<uint64_t>(1e9 / rate);
+    uint64_t start = nowNs() + 10 * 1000 * 1000;
+
+    std::thread injector([&]() {
+        for (unsigned i = 0; i < count; ++i)
+        {
+            uint64_t due = start + i * period;
+            while (nowNs() < due)
+            {
+                if (due - nowNs() > 200 * 1000)
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+            sent[i] = nowNs();
+            inject(ctx, input, i);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(sDrainMs));
+        done = true;
+        wake(ctx);
+    });
+
+    if (mode == Mode::Threaded)
+    {
+        // Decode on one thread, consume on this one, like an engine with a
+        // dedicated input thread.
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<Event> handoff;
+        bool decoderDone = false;
+
+        std::thread decoder([&]() {
+            while (!done)
+            {
+                eventQueue.update();
+                std::lock_guard<std::mutex> lock(mutex);
+                while (!eventQueue.empty())
+                {
+                    handoff.push_back(eventQueue.front());
+                    eventQueue.pop();
+                }
+                ready.notify_one();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            decoderDone = true;
+            ready.notify_one();
+        });
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (numReceived < count)
+        {
+            ready.wait(lock, [&]() { return !handoff.empty() || decoderDone; });
+            if (handoff.empty() && decoderDone)
+            {
+                break;
+            }
+            if (isMeasured(handoff.front(), input))
+            {
+                received[numReceived++] = nowNs();
+            }
+            handoff.pop_front();
+        }
+        lock.unlock();
+        decoder.join();
+    }
+    else
+    {
+        while (numReceived < count && !done)
+        {
+            eventQueue.update();
+            while (!eventQueue.empty())
+            {
+                if (isMeasured(eventQueue.front(), input) &&
+                    numReceived < count)
+                {
+                    received[numReceived++] = nowNs();
+                }
+                eventQueue.pop();
+            }
+        }
+    }
+    injector.join();
+
+    Stats stats;
+    stats.lost = count - numReceived;
+    if (numReceived == 0)
+    {
+        return stats;
+    }
+
+    std::vector<double> latencies(numReceived);
+    double sum = 0.0;
+    for (unsigned i = 0; i < numReceived; ++i)
+    {
+        latencies[i] = (received[i] - sent[i]) / 1000.0;
+        sum += latencies[i];
+    }
+    std::sort(latencies.begin(), latencies.end());
+    stats.p50 = latencies[numReceived / 2];
+    stats.p90 = latencies[numReceived * 9 / 10];
+    stats.p99 = latencies[numReceived * 99 / 100];
+    stats.max = latencies.back();
+    stats.mean = sum / numReceived;
+    double seconds = (received[numReceived - 1] - sent[0]) / 1e9;
+    stats.achievedRate = seconds > 0.0 ? numReceived / seconds : 0.0;
+    return stats;
+}
+
+void printHeader()
+{
+    printf("  %-9s %10s %10s %9s %9s %9s %9s %9s %7s\n", "mode", "rate/s",
+           "achieved", "mean us", "p50 us", "p90 us", "p99 us", "max us",
+           "lost");
+}
+
+void printStats(Mode mode, double rate, const Stats& s)
+{
+    printf("  %-9s %10.0f %10.0f %9.1f %9.1f %9.1f %9.1f %9.1f %7u\n",
+           sModeNames[static_cast<int>(mode)], rate, s.achievedRate, s.mean,
+           s.p50, s.p90, s.p99, s.max, s.lost);
+    fflush(stdout);
+}
+
+bool isSaturated(const Stats& s, unsigned count)
+{
+    // Losing events or falling a frame behind means the path can't keep up.
+    return s.lost > count / 100 || s.p99 > 16000.0;
+}
+
+bool parseOptions(int argc, const char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--display") == 0)
+        {
+            options.useDisplay = true;
+        }
+        else if (strcmp(arg, "--sweep") == 0)
+        {
+            options.sweep = true;
+        }
+        else if (strcmp(arg, "--keys") == 0)
+        {
+            options.input = Input::Key;
+        }
+        else if (strcmp(arg, "--events") == 0 && value != nullptr)
+        {
+            options.events = static_cast<unsigned>(atoi(value));
+            ++i;
+        }
+        else if (strcmp(arg, "--rate") == 0 && value != nullptr)
+        {
+            options.rate = atof(value);
+            ++i;
+        }
+        else if (strcmp(arg, "--mode") == 0 && value != nullptr)
+        {
+            for (int m = 0; m < static_cast<int>(Mode::ModeMax); ++m)
+            {
+                if (strcmp(value, sModeNames[m]) == 0)
+                {
+                    options.mode = m;
+                }
+            }
+            if (options.mode < 0)
+            {
+                return false;
+            }
+            ++i;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return options.events > 0 && options.rate > 0.0;
+}
+}
+
+int main(int argc, const char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printf("usage: %s [--display] [--keys] [--events N] [--rate HZ] "
+               "[--sweep] [--mode poll|wait|threaded]\n"
+               "  --display  use $DISPLAY instead of spawning Xvfb\n",
+               argv[0]);
+        return 1;
+    }
+
+    XvfbSession xvfb;
+    if (!xvfb.start(options.useDisplay))
+    {
+        return 1;
+    }
+
+    int screenNum = 0;
+    xcb_connection_t* connection = xcb_connect(nullptr, &screenNum);
+    xcb_connection_t* injector = xcb_connect(nullptr, nullptr);
+    if (xcb_connection_has_error(connection) > 0 ||
+        xcb_connection_has_error(injector) > 0)
+    {
+        fprintf(stderr, "Could not connect to %s.\n", xvfb.getDisplay());
+        return 1;
+    }
+
+    const xcb_query_extension_reply_t* xtest =
+        xcb_get_extension_data(injector, &xcb_test_id);
+    if (xtest == nullptr || !xtest->present)
+    {
+        fprintf(stderr, "The X server doesn't support XTEST.\n");
+        return 1;
+    }
+
+    xcb_screen_iterator_t iter =
+        xcb_setup_roots_iterator(xcb_get_setup(connection));
+    for (int i = 0; i < screenNum; ++i)
+    {
+        xcb_screen_next(&iter);
+    }
+    xcb_screen_t* screen = iter.data;
+    xwin::init(argc, argv, connection, screen);
+
+    EventQueue eventQueue;
+    Window window;
+    WindowDesc desc;
+    desc.x = 0;
+    desc.y = 0;
+    desc.width = screen->width_in_pixels;
+    desc.height = screen->height_in_pixels;
+    desc.centered = false;
+    if (!window.create(desc, eventQueue))
+    {
+        fprintf(stderr, "Could not create a window.\n");
+        return 1;
+    }
+
+    // Wait for the window to be exposed before measuring anything.
+    bool exposed = false;
+    while (!exposed)
+    {
+        eventQueue.update();
+        while (!eventQueue.empty())
+        {
+            exposed |= hasReachedStartupPhase(StartupPhase::FirstExpose);
+            eventQueue.pop();
+        }
+    }
+
+    Context ctx = {injector, screen->root, window.getXcbWindow(), desc.width,
+                   &eventQueue};
+
+    printf("XCB input latency, %s injection on %s, %u events per trial\n",
+           options.input == Input::Motion ? "motion" : "key",
+           xvfb.getDisplay(), options.events);
+
+    for (int m = 0; m < static_cast<int>(Mode::ModeMax); ++m)
+    {
+        if (options.mode >= 0 && options.mode != m)
+        {
+            continue;
+        }
+        Mode mode = static_cast<Mode>(m);
+        printf("\n");
+        printHeader();
+
+        double rate = options.rate;
+        for (;;)
+        {
+            Stats stats =
+                runTrial(ctx, mode, options.input, rate, options.events);
+            printStats(mode, rate, stats);
+            if (!options.sweep || isSaturated(stats, options.events) ||
+                rate >= sMaxRate)
+            {
+                if (options.sweep)
+                {
+                    printf("  %s saturates at ~%.0f events/s\n",
+                           sModeNames[m], rate);
+                }
+                break;
+            }
+            rate *= 2.0;
+        }
+    }
+
+    window.close();
+    xcb_disconnect(injector);
+    xcb_disconnect(connection);
+    return 0;
+}
@@ -0,0 +1,299 @@
+#include "Bench.h"
+#include "Xvfb.h"
+
+#include "CrossWindow/CrossWindow.h"
+
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Multi-window scaling of the XCB backend, for video walls driving hundreds
+ * of windows from one process. For each window count N it measures:
+ *
+ * - create: Window::create per window, including a server round trip.
+ * - bulk: createWindows per window for the same set, pipelined.
+ * - memory: resident memory per window.
+ * - idle update: EventQueue::update() with nothing pending.
+ * - update/event: decoding and routing one ClientMessage per window.
+ * - route/event: pushEvent of synthetic motion spread over every window.
+ *
+ * Per-window or per-event costs that grow by more than 2x from the smallest
+ * to the largest N are flagged as scaling worse than linearly.
+ */
+using namespace xwin;
+using namespace xwin::bench;
+
+namespace
+{
+struct Sample
+{
+    unsigned windows;
+    double createUs;
+    double bulkCreateUs;
+    double memoryKb;
+    double idleUpdateUs;
+    double updateEventNs;
+    double routeEventNs;
+    unsigned misrouted;
+};
+
+// Flag costs that grow by more than this from the smallest N to the largest.
+const double sScaleThreshold = 2.0;
+
+size_t getResidentKb()
+{
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (file == nullptr)
+    {
+        return 0;
+    }
+    unsigned long pages = 0;
+    unsigned long resident = 0;
+    if (fscanf(file, "%lu %lu", &pages, &resident) != 2)
+    {
+        resident = 0;
+    }
+    fclose(file);
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+// Wait for every request so far to be processed by the server.
+void sync(xcb_connection_t* connection)
+{
+    free(xcb_get_input_focus_reply(connection, xcb_get_input_focus(connection),
+                                   nullptr));
+}
+
+void drain(EventQueue& eventQueue)
+{
+    eventQueue.setProcessingMode(EventQueue::ProcessingMode::Poll);
+    eventQueue.update();
+    while (!eventQueue.empty())
+    {
+        eventQueue.pop();
+    }
+}
+
+Sample measure(xcb_connection_t* connection, unsigned count)
+{
+    Sample sample = {};
+    sample.windows = count;
+
+    EventQueue eventQueue;
+    std::vector<std::unique_ptr<Window>> windows;
+    windows.reserve(count);
+
+    size_t residentBefore = getResidentKb();
+    uint64_t start = nowNs();
+    for (unsigned i = 0; i < count; ++i)
+    {
+        WindowDesc desc;
+        desc.centered = false;
+        desc.width = 64;
+        desc.height = 64;
+        desc.x = static_cast<long>((i % 16) * 64);
+        desc.y = static_cast<long>((i / 16) * 64);
+        windows.emplace_back(new Window());
+        windows.back()->create(desc, eventQueue);
+    }
+    sync(connection);
+    sample.createUs = (nowNs() - start) / 1000.0 / count;
+    sample.memoryKb =
+        static_cast<double>(getResidentKb() - residentBefore) / count;
+
+    sync(connection);
+    drain(eventQueue);
+
+    // Idle update, nothing pending.
+    const unsigned idleRuns = 2000;
+    start = nowNs();
+    for (unsigned i = 0; i < idleRuns; ++i)
+    {
+        eventQueue.update();
+    }
+    sample.idleUpdateUs = (nowNs() - start) / 1000.0 / idleRuns;
+
+    // One real event per window through the server, decode and route.
+    const unsigned rounds = 20;
+    uint64_t updateNs = 0;
+    unsigned decoded = 0;
+    for (unsigned r = 0; r < rounds; ++r)
+    {
+        for (const std::unique_ptr<Window>& window : windows)
+        {
+            xcb_client_message_event_t message = {};
+            message.response_type = XCB_CLIENT_MESSAGE;
+            message.format = 32;
+            message.window = window->getXcbWindow();
+            xcb_send_event(connection, 0, message.window,
+                           XCB_EVENT_MASK_NO_EVENT,
+                           reinterpret_cast<const char*>(&message));
+        }
+        sync(connection);
+        start = nowNs();
+        eventQueue.update();
+        updateNs += nowNs() - start;
+        decoded += count;
+        drain(eventQueue);
+    }
+    sample.updateEventNs = static_cast<double>(updateNs) / decoded;
+
+    // Synthetic motion spread over every window, checking each is routed to
+    // the window it was sent to.
+    const unsigned routed = 200000;
+    uint64_t routeNs = 0;
+    for (unsigned i = 0; i < routed; ++i)
+    {
+        unsigned target = static_cast<unsigned>((i * 2654435761u) % count);
+        xcb_motion_notify_event_t motion = {};
+        motion.response_type = XCB_MOTION_NOTIFY;
+        motion.event = windows[target]->getXcbWindow();
+        start = nowNs();
+        eventQueue.pushEvent(reinterpret_cast<xcb_generic_event_t*>(&motion));
+        routeNs += nowNs() - start;
+        if (eventQueue.front().window != windows[target].get())
+        {
+            ++sample.misrouted;
+        }
+        eventQueue.pop();
+    }
+    sample.routeEventNs = static_cast<double>(routeNs) / routed;
+
+    // The same set again, created in one pipelined batch.
+    std::vector<std::unique_ptr<Window>> bulk;
+    std::vector<Window*> bulkWindows;
+    std::vector<WindowDesc> bulkDescs(count);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        bulk.emplace_back(new Window());
+        bulkWindows.push_back(bulk.back().get());
+        bulkDescs[i].centered = false;
+        bulkDescs[i].width = 64;
+        bulkDescs[i].height = 64;
+        bulkDescs[i].x = static_cast<long>((i % 16) * 64);
+        bulkDescs[i].y = static_cast<long>((i / 16) * 64);
+    }
+    start = nowNs();
+    createWindows(bulkWindows.data(), bulkDescs.data(), count, eventQueue);
+    sync(connection);
+    sample.bulkCreateUs = (nowNs() - start) / 1000.0 / count;
+    for (const std::unique_ptr<Window>& window : bulk)
+    {
+        window->close();
+    }
+
+    for (const std::unique_ptr<Window>& window : windows)
+    {
+        window->close();
+    }
+    sync(connection);
+    drain(eventQueue);
+    return sample;
+}
+
+void checkScaling(const char* name, double first, double last)
+{
+    if (first > 0.0 && last / first > sScaleThreshold)
+    {
+        printf("  WARNING: %s grows %.1fx from the smallest to the largest N, "
+               "worse than linear.\n",
+               name, last / first);
+    }
+}
+}
+
+int main(int argc, const char** argv)
+{
+    bool useDisplay = false;
+    unsigned maxWindows = 256;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--display") == 0)
+        {
+            useDisplay = true;
+        }
+        else if (strcmp(argv[i], "--max") == 0 && i + 1 < argc)
+        {
+            maxWindows = static_cast<unsigned>(atoi(argv[++i]));
+        }
+        else
+        {
+            printf("usage: %s [--max N] [--display]\n"
+                   "  --display  use $DISPLAY instead of spawning Xvfb\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+
+    XvfbSession xvfb;
+    if (!xvfb.start(useDisplay))
+    {
+        return 1;
+    }
+
+    int screenNum = 0;
+    xcb_connection_t* connection = xcb_connect(nullptr, &screenNum);
+    if (xcb_connection_has_error(connection) > 0)
+    {
+        fprintf(stderr, "Could not connect to %s.\n", xvfb.getDisplay());
+        return 1;
+    }
+    xcb_screen_iterator_t iter =
+        xcb_setup_roots_iterator(xcb_get_setup(connection));
+    for (int i = 0; i < screenNum; ++i)
+    {
+        xcb_screen_next(&iter);
+    }
+    xwin::init(argc, argv, connection, iter.data);
+
+    printf("XCB multi-window scaling on %s\n\n", xvfb.getDisplay());
+    printf("  %8s %12s %12s %12s %14s %14s %14s %10s\n", "windows",
+           "create us", "bulk us", "memory KB", "idle update us", "update/evt ns", "route/evt ns",
+           "misrouted");
+
+    std::vector<Sample> samples;
+    for (unsigned count = 1; count <= maxWindows; count *= 4)
+    {
+        samples.push_back(measure(connection, count));
+        const Sample& s = samples.back();
+        printf("  %8u %12.1f %12.1f %12.1f %14.2f %14.1f %14.1f %10u\n",
+               s.windows, s.createUs, s.bulkCreateUs, s.memoryKb,
+               s.idleUpdateUs, s.updateEventNs, s.routeEventNs, s.misrouted);
+        fflush(stdout);
+    }
+    if (samples.back().windows != maxWindows && maxWindows > 0)
+    {
+        samples.push_back(measure(connection, maxWindows));
+        const Sample& s = samples.back();
+        printf("  %8u %12.1f %12.1f %12.1f %14.2f %14.1f %14.1f %10u\n",
+               s.windows, s.createUs, s.bulkCreateUs, s.memoryKb,
+               s.idleUpdateUs, s.updateEventNs, s.routeEventNs, s.misrouted);
+    }
+
+    printf("\n");
+    const Sample& first = samples.front();
+    const Sample& last = samples.back();
+    checkScaling("create per window", first.createUs, last.createUs);
+    checkScaling("bulk create per window", first.bulkCreateUs,
+                 last.bulkCreateUs);
+    checkScaling("idle update", first.idleUpdateUs, last.idleUpdateUs);
+    checkScaling("update per event", first.updateEventNs, last.updateEventNs);
+    checkScaling("routing per event", first.routeEventNs, last.routeEventNs);
+
+    bool misrouted = false;
+    for (const Sample& s : samples)
+    {
+        misrouted |= s.misrouted > 0;
+    }
+    if (misrouted)
+    {
+        printf("  ERROR: events were routed to the wrong window.\n");
+    }
+
+    xcb_disconnect(connection);
+    return misrouted ? 1 : 0;
+}
@@ -0,0 +1,105 @@
+#include "Bench.h"
+#include "BenchEvents.h"
+
+#include "CrossWindow/Common/EventPipeline.h"
+
+using namespace xwin;
+using namespace xwin::bench;
+
+namespace
+{
+const char* sGroup = "EventPipeline stages";
+
+// A stage that does nearly nothing, so timings show the cost of a stage
+// itself.
+struct PassThrough
+{
+    unsigned count = 0;
+
+    template <typename Next> void process(const Event& e, Next& next)
+    {
+        ++count;
+        next(e);
+    }
+};
+
+typedef EventStageAdapter<PassThrough> RuntimePassThrough;
+
+// One op is pushing a mouse move through the pipeline into the queue and
+// popping it.
+void pushPop(EventQueue& eventQueue, uint64_t iterations)
+{
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        pushMouseMove(eventQueue, static_cast<unsigned>(i));
+        doNotOptimize(eventQueue.front());
+        eventQueue.pop();
+    }
+}
+
+void noPipeline(uint64_t iterations)
+{
+    EventQueue eventQueue;
+    pushPop(eventQueue, iterations);
+}
+
+template <typename Pipeline> void staticPipeline(uint64_t iterations)
+{
+    EventQueue eventQueue;
+    Pipeline pipeline;
+    eventQueue.setPipeline(&pipeline);
+    pushPop(eventQueue, iterations);
+}
+
+template <unsigned Stages> void runtimePipeline(uint64_t iterations)
+{
+    EventQueue eventQueue;
+    RuntimePassThrough stages[Stages];
+    EventPipeline pipeline;
+    for (RuntimePassThrough& stage : stages)
+    {
+        pipeline.addStage(&stage);
+    }
+    eventQueue.setPipeline(&pipeline);
+    pushPop(eventQueue, iterations);
+}
+
+void runtimeTypical(uint64_t iterations)
+{
+    EventQueue eventQueue;
+    EventStageAdapter<GamepadDeadZone> deadZone;
+    EventStageAdapter<KeyRemap> remap;
+    EventStageAdapter<EventTypeFilter> filter;
+    EventPipeline pipeline;
+    pipeline.addStage(&deadZone);
+    pipeline.addStage(&remap);
+    pipeline.addStage(&filter);
+    eventQueue.setPipeline(&pipeline);
+    pushPop(eventQueue, iterations);
+}
+
+typedef StaticEventPipeline<PassThrough> Static1;
+typedef StaticEventPipeline<PassThrough, PassThrough, PassThrough,
+                            PassThrough>
+    Static4;
+typedef StaticEventPipeline<PassThrough, PassThrough, PassThrough,
+                            PassThrough, PassThrough, PassThrough,
+                            PassThrough, PassThrough>
+    Static8;
+typedef StaticEventPipeline<GamepadDeadZone, KeyRemap, EventTypeFilter>
+    StaticTypical;
+
+const bool sRegistered =
+    add(sGroup, "none", &noPipeline) &&
+    add(sGroup, "static/stages_0", &staticPipeline<StaticEventPipeline<>>) &&
+    add(sGroup, "static/stages_1", &staticPipeline<Static1>) &&
+    add(sGroup, "static/stages_4", &staticPipeline<Static4>) &&
+    add(sGroup, "static/stages_8", &staticPipeline<Static8>) &&
+    add(sGroup, "static/deadzone_remap_filter",
+        &staticPipeline<StaticTypical>) &&
+    add(sGroup, "runtime/stages_0", &runtimePipeline<0>) &&
+    add(sGroup, "runtime/stages_1", &runtimePipeline<1>) &&
+    add(sGroup, "runtime/stages_4", &runtimePipeline<4>) &&
+    add(sGroup, "runtime/stages_8", &runtimePipeline<8>) &&
+    add(sGroup, "runtime/deadzone_remap_filter", &runtimeTypical);
+}
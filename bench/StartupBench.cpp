@@ -0,0 +1,179 @@
+#include "Bench.h"
+#include "Xvfb.h"
+
+#include "CrossWindow/Common/Startup.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Cold start benchmark, launches CrossWindowStartupChild N times against
+ * Xvfb and reports each startup phase from main() to the first expose, plus
+ * the wall time from fork to exit.
+ */
+using namespace xwin;
+using namespace xwin::bench;
+
+namespace
+{
+const size_t sNumPhases = static_cast<size_t>(StartupPhase::StartupPhaseMax);
+
+struct Run
+{
+    uint64_t phases[sNumPhases];
+    uint64_t wall;
+};
+
+bool launch(const char* path, Run& run)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return false;
+    }
+
+    uint64_t start = nowNs();
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        return false;
+    }
+    if (pid == 0)
+    {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execl(path, path, static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    close(fds[1]);
+
+    std::string output;
+    char buffer[512];
+    ssize_t n;
+    while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+    {
+        output.append(buffer, static_cast<size_t>(n));
+    }
+    close(fds[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    run.wall = nowNs() - start;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        return false;
+    }
+
+    size_t line = output.find("XWIN_STARTUP");
+    if (line == std::string::npos)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < sNumPhases; ++i)
+    {
+        std::string key =
+            std::string(" ") +
+            getStartupPhaseName(static_cast<StartupPhase>(i)) + "=";
+        size_t at = output.find(key, line);
+        if (at == std::string::npos)
+        {
+            return false;
+        }
+        run.phases[i] = strtoull(output.c_str() + at + key.size(), nullptr, 10);
+    }
+    return true;
+}
+
+void printRow(const char* name, std::vector<uint64_t> values)
+{
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    printf("  %-16s %10.1f %10.1f %10.1f %10.1f\n", name, values[0] / 1000.0,
+           values[n / 2] / 1000.0, values[n * 9 / 10] / 1000.0,
+           values[n - 1] / 1000.0);
+}
+}
+
+int main(int argc, const char** argv)
+{
+    unsigned runs = 50;
+    bool useDisplay = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+        {
+            runs = static_cast<unsigned>(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--display") == 0)
+        {
+            useDisplay = true;
+        }
+        else
+        {
+            printf("usage: %s [--runs N] [--display]\n"
+                   "  --display  use $DISPLAY instead of spawning Xvfb\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+    if (runs == 0)
+    {
+        return 1;
+    }
+
+    XvfbSession xvfb;
+    if (!xvfb.start(useDisplay))
+    {
+        return 1;
+    }
+
+    std::vector<Run> results;
+    for (unsigned i = 0; i < runs; ++i)
+    {
+        Run run;
+        if (!launch(XWIN_STARTUP_CHILD, run))
+        {
+            fprintf(stderr, "Run %u of %s failed.\n", i, XWIN_STARTUP_CHILD);
+            return 1;
+        }
+        results.push_back(run);
+    }
+
+    printf("XCB startup on %s, %u runs, microseconds\n\n", xvfb.getDisplay(),
+           runs);
+    printf("  %-16s %10s %10s %10s %10s\n", "phase", "min", "median", "p90",
+           "max");
+
+    // Each phase as time spent since the previous one.
+    for (size_t p = 1; p < sNumPhases; ++p)
+    {
+        std::vector<uint64_t> deltas;
+        for (const Run& run : results)
+        {
+            deltas.push_back(run.phases[p] >= run.phases[p - 1]
+                                 ? run.phases[p] - run.phases[p - 1]
+                                 : 0);
+        }
+        std::string name =
+            std::string("+") + getStartupPhaseName(static_cast<StartupPhase>(p));
+        printRow(name.c_str(), deltas);
+    }
+
+    std::vector<uint64_t> totals;
+    std::vector<uint64_t> walls;
+    for (const Run& run : results)
+    {
+        totals.push_back(run.phases[sNumPhases - 1]);
+        walls.push_back(run.wall);
+    }
+    printf("\n");
+    printRow("main->expose", totals);
+    printRow("fork->exit", walls);
+    return 0;
+}
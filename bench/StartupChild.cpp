@@ -0,0 +1,46 @@
+#include "CrossWindow/Common/Startup.h"
+#include "CrossWindow/CrossWindow.h"
+#include "CrossWindow/Main/Main.h"
+
+#include <stdio.h>
+
+/**
+ * The process CrossWindowStartupBench launches, it goes through the real
+ * platform main, creates one window, waits for its first expose and prints
+ * the startup phase timings.
+ */
+void xmain(int, const char**)
+{
+    xwin::EventQueue eventQueue;
+    xwin::Window window;
+    xwin::WindowDesc desc;
+    desc.width = 640;
+    desc.height = 480;
+    if (!window.create(desc, eventQueue))
+    {
+        return;
+    }
+
+    while (!xwin::hasReachedStartupPhase(xwin::StartupPhase::FirstExpose))
+    {
+        eventQueue.update();
+        while (!eventQueue.empty())
+        {
+            eventQueue.pop();
+        }
+    }
+
+    printf("XWIN_STARTUP");
+    for (size_t i = 0;
+         i < static_cast<size_t>(xwin::StartupPhase::StartupPhaseMax); ++i)
+    {
+        xwin::StartupPhase phase = static_cast<xwin::StartupPhase>(i);
+        printf(" %s=%llu", xwin::getStartupPhaseName(phase),
+               static_cast<unsigned long long>(
+                   xwin::getStartupPhaseTime(phase)));
+    }
+    printf("\n");
+    fflush(stdout);
+
+    window.close();
+}
@@ -0,0 +1,120 @@
+#include "Bench.h"
+#include "Xvfb.h"
+
+#include "CrossWindow/CrossWindow.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+/**
+ * Cross thread wake latency of the XCB backend: a worker thread posts User
+ * events stamped with the time of the post while the main thread sleeps in
+ * EventQueue::update() in Wait mode, and the main thread measures how long
+ * each took to come out of update().
+ */
+using namespace xwin;
+using namespace xwin::bench;
+
+namespace
+{
+double percentile(std::vector<double>& samples, double p)
+{
+    std::sort(samples.begin(), samples.end());
+    size_t i = static_cast<size_t>(p * (samples.size() - 1));
+    return samples[i];
+}
+}
+
+int main(int argc, const char** argv)
+{
+    bool useDisplay = false;
+    unsigned posts = 2000;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--display") == 0)
+        {
+            useDisplay = true;
+        }
+        else if (strcmp(argv[i], "--posts") == 0 && i + 1 < argc)
+        {
+            posts = static_cast<unsigned>(atoi(argv[++i]));
+        }
+        else
+        {
+            printf("usage: %s [--posts N] [--display]\n"
+                   "  --display  use $DISPLAY instead of spawning Xvfb\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+    if (posts == 0)
+    {
+        return 0;
+    }
+
+    XvfbSession xvfb;
+    if (!xvfb.start(useDisplay))
+    {
+        return 1;
+    }
+
+    int screenNum = 0;
+    xcb_connection_t* connection = xcb_connect(nullptr, &screenNum);
+    if (xcb_connection_has_error(connection) > 0)
+    {
+        fprintf(stderr, "Could not connect to %s.\n", xvfb.getDisplay());
+        return 1;
+    }
+    xcb_screen_iterator_t iter =
+        xcb_setup_roots_iterator(xcb_get_setup(connection));
+    for (int i = 0; i < screenNum; ++i)
+    {
+        xcb_screen_next(&iter);
+    }
+    xwin::init(argc, argv, connection, iter.data);
+
+    EventQueue eventQueue;
+    eventQueue.setProcessingMode(EventQueue::ProcessingMode::Wait);
+
+    // Spaced out so every post finds the main thread asleep.
+    std::thread worker([&]() {
+        for (unsigned i = 0; i < posts; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+            eventQueue.postUserEvent(UserData(i, nowNs()));
+        }
+    });
+
+    std::vector<double> latencies;
+    latencies.reserve(posts);
+    while (latencies.size() < posts)
+    {
+        eventQueue.update();
+        uint64_t now = nowNs();
+        while (!eventQueue.empty())
+        {
+            const Event& e = eventQueue.front();
+            if (e.type == EventType::User)
+            {
+                latencies.push_back((now - e.data.user.payload[0]) / 1000.0);
+            }
+            eventQueue.pop();
+        }
+    }
+    worker.join();
+
+    printf("XCB post to wake latency on %s, %u posts\n\n", xvfb.getDisplay(),
+           posts);
+    printf("  %10s %10s %10s %10s\n", "p50 us", "p90 us", "p99 us", "max us");
+    printf("  %10.1f %10.1f %10.1f %10.1f\n", percentile(latencies, 0.5),
+           percentile(latencies, 0.9), percentile(latencies, 0.99),
+           percentile(latencies, 1.0));
+
+    xcb_disconnect(connection);
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "Bench.h"
+
+#if defined(XWIN_XCB)
+
+#include "CrossWindow/Common/EventQueue.h"
+
+using namespace xwin;
+using namespace xwin::bench;
+
+/**
+ * Decode throughput of EventQueue::pushEvent per X event type, using
+ * synthetic wire events so no server is needed. Each op decodes one event
+ * and pops whatever it produced.
+ */
+namespace
+{
+const char* sGroup = "XCB pushEvent decode";
+
+void decode(uint64_t iterations, const void* event)
+{
+    EventQueue eventQueue;
+    const xcb_generic_event_t* e =
+        static_cast<const xcb_generic_event_t*>(event);
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        eventQueue.pushEvent(e);
+        while (!eventQueue.empty())
+        {
+            doNotOptimize(eventQueue.front());
+            eventQueue.pop();
+        }
+    }
+}
+
+template <typename T> T makeEvent(uint8_t type)
+{
+    T e = {};
+    e.response_type = type;
+    return e;
+}
+}
+
+XWIN_BENCHMARK(sGroup, KeyPress)
+{
+    xcb_key_press_event_t e = makeEvent<xcb_key_press_event_t>(XCB_KEY_PRESS);
+    e.detail = 0x41;
+    e.state = XCB_MOD_MASK_SHIFT;
+    decode(iterations, &e);
+}
+
+XWIN_BENCHMARK(sGroup, KeyRelease)
+{
+    xcb_key_release_event_t e =
+        makeEvent<xcb_key_release_event_t>(XCB_KEY_RELEASE);
+    e.detail = 0x9;
+    decode(iterations, &e);
+}
+
+XWIN_BENCHMARK(sGroup, ButtonPress)
+{
+    xcb_button_press_event_t e =
+        makeEvent<xcb_button_press_event_t>(XCB_BUTTON_PRESS);
+    e.detail = 1;
+    e.state = XCB_BUTTON_MASK_1;
+    decode(iterations, &e);
+}
+
+XWIN_BENCHMARK(sGroup, ButtonRelease)
+{
+    xcb_button_release_event_t e =
+        makeEvent<xcb_button_release_event_t>(XCB_BUTTON_RELEASE);
+    e.detail = 1;
+    e.state = XCB_BUTTON_MASK_1;
+    decode(iterations, &e);
+}
+
+XWIN_BENCHMARK(sGroup, MotionNotify)
+{
+    xcb_motion_notify_event_t e =
+        makeEvent<xcb_motion_notify_event_t>(XCB_MOTION_NOTIFY);
+    e.event_x = 100;
+    e.event_y = 200;
+    decode(iterations, &e);
+}
+
+XWIN_BENCHMARK(sGroup, EnterNotify)
+{
+    xcb_enter_notify_event_t e =
+        makeEvent<xcb_enter_notify_event_t>(XCB_ENTER_NOTIFY);
+    decode(iterations, &e);
+}
+
+XWIN_BENCHMARK(sGroup, Expose)
+{
+    xcb_expose_event_t e = makeEvent<xcb_expose_event_t>(XCB_EXPOSE);
+    e.width = 1280;
+    e.height = 720;
+    decode(iterations, &e);
+}
+
+XWIN_BENCHMARK(sGroup, ConfigureNotify)
+{
+    xcb_configure_notify_event_t e =
+        makeEvent<xcb_configure_notify_event_t>(XCB_CONFIGURE_NOTIFY);
+    decode(iterations, &e);
+}
+
+XWIN_BENCHMARK(sGroup, ResizeRequest)
+{
+    xcb_resize_request_event_t e =
+        makeEvent<xcb_resize_request_event_t>(XCB_RESIZE_REQUEST);
+    e.width = 1280;
+    e.height = 720;
+    decode(iterations, &e);
+}
+
+XWIN_BENCHMARK(sGroup, ClientMessage)
+{
+    xcb_client_message_event_t e =
+        makeEvent<xcb_client_message_event_t>(XCB_CLIENT_MESSAGE);
+    decode(iterations, &e);
+}
+
+#endif
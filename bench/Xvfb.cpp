@@ -0,0 +1,111 @@
+#include "Xvfb.h"
+
+#include <xcb/xcb.h>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace xwin
+{
+namespace bench
+{
+XvfbSession::~XvfbSession() { stop(); }
+
+bool XvfbSession::start(bool useExisting)
+{
+    if (useExisting)
+    {
+        const char* display = getenv("DISPLAY");
+        if (display == nullptr)
+        {
+            fprintf(stderr, "DISPLAY is not set.\n");
+            return false;
+        }
+        mDisplay = display;
+        return waitForServer(0);
+    }
+
+    for (int n = 99; n < 160; ++n)
+    {
+        char path[64];
+        struct stat info;
+        snprintf(path, sizeof(path), "/tmp/.X%d-lock", n);
+        if (stat(path, &info) == 0)
+        {
+            continue;
+        }
+        snprintf(path, sizeof(path), ":%d", n);
+        mDisplay = path;
+
+        mPid = fork();
+        if (mPid < 0)
+        {
+            return false;
+        }
+        if (mPid == 0)
+        {
+            int devNull = open("/dev/null", O_WRONLY);
+            if (devNull >= 0)
+            {
+                dup2(devNull, STDOUT_FILENO);
+                dup2(devNull, STDERR_FILENO);
+            }
+            execlp("Xvfb", "Xvfb", path, "-screen", "0", "1920x1080x24",
+                   "-nolisten", "tcp", static_cast<char*>(nullptr));
+            _exit(127);
+        }
+
+        setenv("DISPLAY", mDisplay.c_str(), 1);
+        if (waitForServer(5000))
+        {
+            return true;
+        }
+        stop();
+    }
+    fprintf(stderr, "Could not start Xvfb, is it installed?\n");
+    return false;
+}
+
+bool XvfbSession::waitForServer(unsigned timeoutMs)
+{
+    for (unsigned waited = 0;; waited += 10)
+    {
+        xcb_connection_t* connection = xcb_connect(mDisplay.c_str(), nullptr);
+        bool ok = xcb_connection_has_error(connection) == 0;
+        xcb_disconnect(connection);
+        if (ok)
+        {
+            return true;
+        }
+        if (waited >= timeoutMs)
+        {
+            return false;
+        }
+        if (mPid > 0 && waitpid(mPid, nullptr, WNOHANG) == mPid)
+        {
+            // The server exited, most likely the display was taken.
+            mPid = -1;
+            return false;
+        }
+        usleep(10 * 1000);
+    }
+}
+
+void XvfbSession::stop()
+{
+    if (mPid > 0)
+    {
+        kill(mPid, SIGTERM);
+        waitpid(mPid, nullptr, 0);
+        mPid = -1;
+    }
+}
+
+const char* XvfbSession::getDisplay() const { return mDisplay.c_str(); }
+}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <sys/types.h>
+
+namespace xwin
+{
+namespace bench
+{
+/**
+ * Starts a private Xvfb server for the X benchmarks, or reuses $DISPLAY when
+ * asked to. The server is killed when the session is destroyed.
+ */
+class XvfbSession
+{
+  public:
+    ~XvfbSession();
+
+    // Spawn Xvfb on the first free display from :99 and point $DISPLAY at
+    // it, or just check $DISPLAY is reachable when useExisting is set.
+    bool start(bool useExisting = false);
+
+    void stop();
+
+    const char* getDisplay() const;
+
+  protected:
+    bool waitForServer(unsigned timeoutMs);
+
+    pid_t mPid = -1;
+    std::string mDisplay;
+};
+}
+}
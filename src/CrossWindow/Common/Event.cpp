@@ -65,6 +65,24 @@ Event::Event(DpiData d, Window* window) : type(EventType::DPI), window(window)
     data.dpi = d;
 }
 
+Event::Event(TimerData d, Window* window)
+    : type(EventType::Timer), window(window)
+{
+    data.timer = d;
+}
+
+Event::Event(FdReadyData d, Window* window)
+    : type(EventType::FdReady), window(window)
+{
+    data.fdReady = d;
+}
+
+Event::Event(UserData d, Window* window)
+    : type(EventType::User), window(window)
+{
+    data.user = d;
+}
+
 Event::~Event() {}
 
 ResizeData::ResizeData(unsigned width, unsigned height, bool resizing)
@@ -211,4 +229,21 @@ MouseRawData::MouseRawData(int deltax, int deltay)
 {
 }
 DpiData::DpiData(float scale) : scale(scale) {}
+
+TimerData::TimerData(unsigned id, unsigned long long expirations)
+    : id(id), expirations(expirations)
+{
+}
+
+UserData::UserData(unsigned code, unsigned long long payload0,
+                   unsigned long long payload1, void* pointer)
+    : code(code), payload{payload0, payload1}, pointer(pointer)
+{
+}
+
+FdReadyData::FdReadyData(unsigned id, int fd, bool readable, bool writable,
+                         bool hangup)
+    : id(id), fd(fd), readable(readable), writable(writable), hangup(hangup)
+{
+}
 }
@@ -62,6 +62,15 @@ enum class EventType : size_t
     // Hovering a file over a window
     HoverFile,
 
+    // A timer registered with the EventQueue expired
+    Timer,
+
+    // A file descriptor source registered with the EventQueue is ready
+    FdReady,
+
+    // An application defined event posted with EventQueue::postUserEvent
+    User,
+
     EventTypeMax
 };
 
@@ -476,6 +485,66 @@ struct GamepadData
     static const EventType type = EventType::Gamepad;
 };
 
+/**
+ * Data passed with Timer events
+ */
+struct TimerData
+{
+    // The id returned when the timer was added
+    unsigned id;
+
+    // Times the timer expired since it was last delivered, more than 1 if
+    // the application fell behind a repeating timer
+    unsigned long long expirations;
+
+    TimerData(unsigned id, unsigned long long expirations);
+
+    static const EventType type = EventType::Timer;
+};
+
+/**
+ * Data passed with FdReady events
+ */
+struct FdReadyData
+{
+    // The id returned when the source was added
+    unsigned id;
+
+    int fd;
+
+    bool readable;
+
+    bool writable;
+
+    // The other end hung up or the descriptor is in an error state
+    bool hangup;
+
+    FdReadyData(unsigned id, int fd, bool readable, bool writable,
+                bool hangup);
+
+    static const EventType type = EventType::FdReady;
+};
+
+/**
+ * Data passed with User events
+ */
+struct UserData
+{
+    // Application defined code identifying the event
+    unsigned code;
+
+    // Small inline payload, interpreted by the application
+    unsigned long long payload[2];
+
+    // Optional pointer, its lifetime is up to the application
+    void* pointer;
+
+    UserData(unsigned code, unsigned long long payload0 = 0,
+             unsigned long long payload1 = 0, void* pointer = nullptr);
+
+    static const EventType type = EventType::User;
+};
+
 /**
  * SDL does something similar:
  * <https://www.libsdl.org/release/SDL-1.2.15/docs/html/sdlevent.html>
@@ -491,6 +560,9 @@ union EventData {
     TouchData touch;
     GamepadData gamepad;
     MouseRawData mouseRaw;
+    TimerData timer;
+    FdReadyData fdReady;
+    UserData user;
 
     EventData() {}
 
@@ -531,6 +603,12 @@ class Event
 
     Event(DpiData data, Window* window = nullptr);
 
+    Event(TimerData data, Window* window = nullptr);
+
+    Event(FdReadyData data, Window* window = nullptr);
+
+    Event(UserData data, Window* window = nullptr);
+
     ~Event();
     
     bool operator==(const Event& other) const
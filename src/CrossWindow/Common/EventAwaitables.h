@@ -0,0 +1,152 @@
+#pragma once
+
+/**
+ * Coroutine awaitables for EventQueue, available to code compiled as C++20.
+ * The library itself still builds as C++14 and its ABI doesn't change.
+ * Awaiting registers an EventWaiter that lives in the coroutine frame, so
+ * waiting never allocates, and the coroutine is resumed directly from
+ * EventQueue::update() as the matching event is decoded. Matched events are
+ * handed to the waiters instead of being queued.
+ *
+ *     xwin::EventTask toolFlow(xwin::EventQueue& queue)
+ *     {
+ *         xwin::KeyboardData key = co_await queue.next<xwin::KeyboardData>();
+ *         std::optional<xwin::Event> closed = co_await queue.any(
+ *             xwin::EventType::Close, std::chrono::seconds(5));
+ *     }
+ */
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define XWIN_HAS_COROUTINES 1
+#endif
+#endif
+
+#if XWIN_HAS_COROUTINES
+
+#include "EventLanes.h"
+#include "MemoryResource.h"
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <optional>
+
+namespace xwin
+{
+/**
+ * A fire and forget coroutine that starts immediately and frees its frame
+ * when it finishes. Frames come from the default MemoryResource.
+ */
+class EventTask
+{
+  public:
+    struct promise_type
+    {
+        EventTask get_return_object() { return EventTask(); }
+
+        std::suspend_never initial_suspend() noexcept { return {}; }
+
+        std::suspend_never final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+
+        void unhandled_exception() { std::terminate(); }
+
+        static void* operator new(size_t size)
+        {
+            return getDefaultMemoryResource()->allocate(size);
+        }
+
+        static void operator delete(void* p, size_t size)
+        {
+            getDefaultMemoryResource()->deallocate(p, size);
+        }
+    };
+};
+
+namespace detail
+{
+inline uint32_t typeBit(EventType type)
+{
+    return 1u << static_cast<size_t>(type);
+}
+
+// Event payloads are all members of the EventData union, so they share its
+// address.
+template <typename T> struct EventPayload
+{
+    static const T& get(const Event& e)
+    {
+        return *reinterpret_cast<const T*>(&e.data);
+    }
+};
+
+template <> struct EventPayload<Event>
+{
+    static const Event& get(const Event& e) { return e; }
+};
+}
+
+/**
+ * Awaits the next event of the given types. T is Event, or one of the event
+ * data structs (KeyboardData, ResizeData...) to receive just its payload.
+ * With a timeout the result is a std::optional, empty if it timed out.
+ */
+template <typename T, bool Timed>
+class EventAwaitable : public EventWaiter
+{
+  public:
+    EventAwaitable(EventLanes& lanes, uint32_t mask,
+                   std::chrono::nanoseconds timeout)
+        : mLanes(lanes)
+    {
+        typeMask = mask;
+        mTimeoutNs = static_cast<uint64_t>(timeout.count());
+    }
+
+    EventAwaitable(const EventAwaitable&) = delete;
+    EventAwaitable& operator=(const EventAwaitable&) = delete;
+
+    ~EventAwaitable() { mLanes.removeWaiter(this); }
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        mHandle = handle;
+        deadlineNs =
+            Timed ? getSteadyTimeNs() + (mTimeoutNs > 0 ? mTimeoutNs : 1)
+                  : 0;
+        mLanes.addWaiter(this);
+    }
+
+    auto await_resume() const
+    {
+        if constexpr (Timed)
+        {
+            return timedOut ? std::optional<T>()
+                            : std::optional<T>(
+                                  detail::EventPayload<T>::get(event));
+        }
+        else
+        {
+            return detail::EventPayload<T>::get(event);
+        }
+    }
+
+    void wake() override { mHandle.resume(); }
+
+  protected:
+    EventLanes& mLanes;
+    std::coroutine_handle<> mHandle;
+    uint64_t mTimeoutNs = 0;
+};
+
+// Combine event types for EventQueue::any(), such as
+// getEventTypeMask(EventType::Close, EventType::Resize).
+template <typename... Types> uint32_t getEventTypeMask(Types... types)
+{
+    return (detail::typeBit(types) | ...);
+}
+}
+#endif
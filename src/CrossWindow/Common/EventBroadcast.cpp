@@ -0,0 +1,125 @@
+#include "EventBroadcast.h"
+
+#include <new>
+
+namespace xwin
+{
+EventBroadcast::EventBroadcast(size_t capacity, MemoryResource* resource)
+    : mResource(resource), mPublished(0)
+{
+    size_t size = 16;
+    while (size < capacity)
+    {
+        size *= 2;
+    }
+    mMask = size - 1;
+    mSlots = static_cast<Event*>(
+        mResource->allocate(sizeof(Event) * size, alignof(Event)));
+    for (size_t i = 0; i < size; ++i)
+    {
+        new (&mSlots[i]) Event();
+    }
+    for (size_t i = 0; i < MaxConsumers; ++i)
+    {
+        mCursors[i].sequence.store(0, std::memory_order_relaxed);
+        mCursors[i].active.store(false, std::memory_order_relaxed);
+    }
+}
+
+EventBroadcast::~EventBroadcast()
+{
+    for (size_t i = 0; i <= mMask; ++i)
+    {
+        mSlots[i].~Event();
+    }
+    mResource->deallocate(mSlots, sizeof(Event) * (mMask + 1), alignof(Event));
+}
+
+EventBroadcast::Consumer EventBroadcast::addConsumer()
+{
+    for (size_t i = 0; i < MaxConsumers; ++i)
+    {
+        if (!mCursors[i].active.load(std::memory_order_acquire))
+        {
+            mCursors[i].sequence.store(
+                mPublished.load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+            mCursors[i].active.store(true, std::memory_order_release);
+            return i;
+        }
+    }
+    return InvalidConsumer;
+}
+
+void EventBroadcast::removeConsumer(Consumer consumer)
+{
+    if (consumer < MaxConsumers)
+    {
+        mCursors[consumer].active.store(false, std::memory_order_release);
+    }
+}
+
+uint64_t EventBroadcast::getSlowestSequence() const
+{
+    uint64_t slowest = mPublished.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < MaxConsumers; ++i)
+    {
+        if (mCursors[i].active.load(std::memory_order_acquire))
+        {
+            uint64_t sequence =
+                mCursors[i].sequence.load(std::memory_order_acquire);
+            if (sequence < slowest)
+            {
+                slowest = sequence;
+            }
+        }
+    }
+    return slowest;
+}
+
+bool EventBroadcast::publish(const Event& e)
+{
+    uint64_t published = mPublished.load(std::memory_order_relaxed);
+    if (published - mSlowest > mMask)
+    {
+        mSlowest = getSlowestSequence();
+        if (published - mSlowest > mMask)
+        {
+            ++mOverruns;
+            return false;
+        }
+    }
+    mSlots[published & mMask] = e;
+    mPublished.store(published + 1, std::memory_order_release);
+    return true;
+}
+
+const Event* EventBroadcast::peek(Consumer consumer) const
+{
+    uint64_t sequence =
+        mCursors[consumer].sequence.load(std::memory_order_relaxed);
+    if (sequence == mPublished.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+    return &mSlots[sequence & mMask];
+}
+
+void EventBroadcast::advance(Consumer consumer)
+{
+    uint64_t sequence =
+        mCursors[consumer].sequence.load(std::memory_order_relaxed);
+    mCursors[consumer].sequence.store(sequence + 1, std::memory_order_release);
+}
+
+size_t EventBroadcast::available(Consumer consumer) const
+{
+    return static_cast<size_t>(
+        mPublished.load(std::memory_order_acquire) -
+        mCursors[consumer].sequence.load(std::memory_order_relaxed));
+}
+
+size_t EventBroadcast::getCapacity() const { return mMask + 1; }
+
+size_t EventBroadcast::getOverrunCount() const { return mOverruns; }
+}
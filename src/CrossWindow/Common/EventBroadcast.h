@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Event.h"
+#include "MemoryResource.h"
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace xwin
+{
+/**
+ * A single producer, multiple consumer broadcast ring in the style of the
+ * LMAX disruptor. The backend writes each event into the ring once, and every
+ * registered consumer (UI, gameplay, telemetry, a recorder...) reads all of
+ * them through its own cursor, without copies and without locking against
+ * the other consumers. Consumers may run on other threads.
+ *
+ * A slot is reused once the slowest consumer has moved past it. The ring
+ * never grows, and events published while it's full are dropped and
+ * counted, since blocking the producer would deadlock consumers that run on
+ * its thread. Size it for the largest burst a frame can produce, or bound
+ * bursts with an UpdateBudget.
+ */
+class EventBroadcast
+{
+  public:
+    typedef size_t Consumer;
+
+    static const size_t MaxConsumers = 16;
+
+    static const Consumer InvalidConsumer = ~(size_t)0;
+
+    // capacity is rounded up to a power of two.
+    EventBroadcast(size_t capacity = 4096,
+                   MemoryResource* resource = getDefaultMemoryResource());
+
+    ~EventBroadcast();
+
+    EventBroadcast(const EventBroadcast&) = delete;
+    EventBroadcast& operator=(const EventBroadcast&) = delete;
+
+    // Register a consumer that sees every event published from now on,
+    // returns InvalidConsumer if MaxConsumers are registered. Register
+    // consumers from the producer's thread.
+    Consumer addConsumer();
+
+    void removeConsumer(Consumer consumer);
+
+    // Called by the producer, returns false if the ring was full and the
+    // event was dropped.
+    bool publish(const Event& e);
+
+    // The consumer's next event, or nullptr if it has read everything. The
+    // event stays valid until the consumer calls advance().
+    const Event* peek(Consumer consumer) const;
+
+    // Move the consumer past its current event.
+    void advance(Consumer consumer);
+
+    // Events published that the consumer hasn't read yet.
+    size_t available(Consumer consumer) const;
+
+    size_t getCapacity() const;
+
+    // Events dropped because the slowest consumer was a full ring behind.
+    size_t getOverrunCount() const;
+
+  protected:
+    // Cursors are padded to a cache line so consumers on different threads
+    // don't contend. (Padded rather than aligned, C++14 new ignores
+    // over-alignment.)
+    struct Cursor
+    {
+        std::atomic<uint64_t> sequence;
+        std::atomic<bool> active;
+        uint8_t padding[64 - sizeof(std::atomic<uint64_t>) -
+                        sizeof(std::atomic<bool>)];
+    };
+
+    uint64_t getSlowestSequence() const;
+
+    MemoryResource* mResource;
+    Event* mSlots;
+    size_t mMask;
+
+    std::atomic<uint64_t> mPublished;
+
+    // Producer side cache of the slowest cursor, refreshed only when the ring
+    // looks full.
+    uint64_t mSlowest = 0;
+
+    size_t mOverruns = 0;
+
+    Cursor mCursors[MaxConsumers];
+};
+}
@@ -0,0 +1,346 @@
+#include "EventDispatcher.h"
+
+#include <new>
+
+namespace xwin
+{
+EventDispatcher::EventDispatcher(size_t workerCount, size_t capacity,
+                                 MemoryResource* resource)
+    : mResource(resource), mTypeMask(0),
+      mCapacity(capacity > 0 ? capacity : 1)
+{
+    mCalls = static_cast<Call*>(mResource->allocate(sizeof(Call) * mCapacity));
+    for (size_t i = 0; i < mCapacity; ++i)
+    {
+        new (&mCalls[i]) Call();
+        mCalls[i].next = mFree;
+        mFree = i;
+    }
+
+    workerCount = workerCount > 0 ? workerCount : 1;
+    mWorkers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i)
+    {
+        mWorkers.emplace_back([this]() { run(); });
+    }
+}
+
+EventDispatcher::~EventDispatcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mWork.notify_all();
+    for (std::thread& worker : mWorkers)
+    {
+        worker.join();
+    }
+
+    for (size_t i = 0; i < mCapacity; ++i)
+    {
+        mCalls[i].~Call();
+    }
+    mResource->deallocate(mCalls, sizeof(Call) * mCapacity);
+}
+
+EventDispatcher::Handler EventDispatcher::addHandler(Window* window,
+                                                     uint32_t typeMask,
+                                                     Callback callback)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t slot = None;
+    for (size_t i = 0; i < MaxHandlers; ++i)
+    {
+        if (mSlots[i].id == InvalidHandler)
+        {
+            slot = i;
+            break;
+        }
+    }
+    if (slot == None)
+    {
+        return InvalidHandler;
+    }
+    size_t strand = acquireStrand(window);
+    if (strand == None)
+    {
+        return InvalidHandler;
+    }
+
+    Slot& s = mSlots[slot];
+    s.id = mNextHandler++;
+    if (mNextHandler == InvalidHandler)
+    {
+        mNextHandler = 1;
+    }
+    s.typeMask = typeMask;
+    s.removed = false;
+    s.strand = strand;
+    s.callback = std::move(callback);
+    ++mStrands[strand].handlers;
+
+    mTypeMask.fetch_or(typeMask, std::memory_order_relaxed);
+    return s.id;
+}
+
+void EventDispatcher::removeHandler(Handler handler)
+{
+    if (handler == InvalidHandler)
+    {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (size_t i = 0; i < MaxHandlers; ++i)
+    {
+        Slot& s = mSlots[i];
+        if (s.id != handler || s.removed)
+        {
+            continue;
+        }
+        s.removed = true;
+        size_t strand = s.strand;
+
+        // A handler removing itself (or another handler) can't wait for the
+        // worker it's running on, the worker frees the slot when it's done.
+        if (!onWorker())
+        {
+            mIdle.wait(lock, [&]() { return !mStrands[strand].running; });
+        }
+        releaseRemoved(strand);
+        return;
+    }
+}
+
+void EventDispatcher::removeWindow(Window* window)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (size_t i = 0; i < MaxHandlers; ++i)
+    {
+        Strand& strand = mStrands[i];
+        if (strand.handlers == 0 || strand.window != window)
+        {
+            continue;
+        }
+        for (size_t j = 0; j < MaxHandlers; ++j)
+        {
+            if (mSlots[j].id != InvalidHandler && mSlots[j].strand == i)
+            {
+                mSlots[j].removed = true;
+            }
+        }
+        if (!onWorker())
+        {
+            mIdle.wait(lock, [&]() { return !strand.running; });
+        }
+        releaseRemoved(i);
+        return;
+    }
+}
+
+bool EventDispatcher::dispatch(const Event& e)
+{
+    uint32_t bit = 1u << static_cast<size_t>(e.type);
+    if ((mTypeMask.load(std::memory_order_relaxed) & bit) == 0)
+    {
+        return true;
+    }
+
+    bool dispatched = true;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (size_t i = 0; i < MaxHandlers; ++i)
+        {
+            Slot& s = mSlots[i];
+            if (s.id == InvalidHandler || s.removed ||
+                (s.typeMask & bit) == 0 ||
+                mStrands[s.strand].window != e.window)
+            {
+                continue;
+            }
+            if (mFree == None)
+            {
+                ++mDrops;
+                dispatched = false;
+                continue;
+            }
+            size_t index = mFree;
+            Call& call = mCalls[index];
+            mFree = call.next;
+            call.event = e;
+            call.handler = s.id;
+            call.slot = i;
+            call.next = None;
+
+            Strand& strand = mStrands[s.strand];
+            if (strand.tail == None)
+            {
+                strand.head = index;
+            }
+            else
+            {
+                mCalls[strand.tail].next = index;
+            }
+            strand.tail = index;
+            ++mQueued;
+            schedule(s.strand);
+        }
+    }
+    return dispatched;
+}
+
+void EventDispatcher::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mIdle.wait(lock, [this]() { return mQueued == 0 && mRunning == 0; });
+}
+
+size_t EventDispatcher::getDropCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mDrops;
+}
+
+size_t EventDispatcher::getWorkerCount() const { return mWorkers.size(); }
+
+void EventDispatcher::run()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true)
+    {
+        mWork.wait(lock, [this]() { return mStopping || mReadyCount > 0; });
+        if (mStopping)
+        {
+            return;
+        }
+
+        size_t index = mReady[mReadyHead];
+        mReadyHead = (mReadyHead + 1) % MaxHandlers;
+        --mReadyCount;
+
+        Strand& strand = mStrands[index];
+        strand.scheduled = false;
+        strand.running = true;
+        ++mRunning;
+
+        // Run the strand's calls in order. The strand can't be rescheduled
+        // while it's running, so it's only ever on one worker.
+        while (strand.head != None && !mStopping)
+        {
+            size_t callIndex = strand.head;
+            Call& call = mCalls[callIndex];
+            strand.head = call.next;
+            if (strand.head == None)
+            {
+                strand.tail = None;
+            }
+            --mQueued;
+
+            Slot& s = mSlots[call.slot];
+            if (s.id == call.handler && !s.removed)
+            {
+                // Slots and their callbacks are only freed while their strand
+                // isn't running, so both are safe to use unlocked.
+                lock.unlock();
+                s.callback(call.event);
+                lock.lock();
+            }
+
+            call.next = mFree;
+            mFree = callIndex;
+        }
+
+        strand.running = false;
+        --mRunning;
+        releaseRemoved(index);
+        if (strand.head != None)
+        {
+            schedule(index);
+        }
+        mIdle.notify_all();
+    }
+}
+
+size_t EventDispatcher::acquireStrand(Window* window)
+{
+    size_t free = None;
+    for (size_t i = 0; i < MaxHandlers; ++i)
+    {
+        Strand& strand = mStrands[i];
+        if (strand.handlers > 0 || strand.running || strand.head != None)
+        {
+            if (strand.window == window)
+            {
+                return i;
+            }
+        }
+        else if (free == None)
+        {
+            free = i;
+        }
+    }
+    if (free != None)
+    {
+        mStrands[free].window = window;
+    }
+    return free;
+}
+
+void EventDispatcher::releaseRemoved(size_t index)
+{
+    Strand& strand = mStrands[index];
+    if (strand.running)
+    {
+        return;
+    }
+    for (size_t i = 0; i < MaxHandlers; ++i)
+    {
+        Slot& s = mSlots[i];
+        if (s.id != InvalidHandler && s.removed && s.strand == index)
+        {
+            s.id = InvalidHandler;
+            s.removed = false;
+            s.strand = None;
+            s.callback = Callback();
+            --strand.handlers;
+        }
+    }
+
+    // Recompute the types worth locking for.
+    uint32_t typeMask = 0;
+    for (size_t i = 0; i < MaxHandlers; ++i)
+    {
+        if (mSlots[i].id != InvalidHandler && !mSlots[i].removed)
+        {
+            typeMask |= mSlots[i].typeMask;
+        }
+    }
+    mTypeMask.store(typeMask, std::memory_order_relaxed);
+}
+
+void EventDispatcher::schedule(size_t index)
+{
+    Strand& strand = mStrands[index];
+    if (strand.scheduled || strand.running)
+    {
+        return;
+    }
+    strand.scheduled = true;
+    mReady[(mReadyHead + mReadyCount) % MaxHandlers] = index;
+    ++mReadyCount;
+    mWork.notify_one();
+}
+
+bool EventDispatcher::onWorker() const
+{
+    std::thread::id self = std::this_thread::get_id();
+    for (const std::thread& worker : mWorkers)
+    {
+        if (worker.get_id() == self)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+}
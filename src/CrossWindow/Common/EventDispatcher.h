@@ -0,0 +1,150 @@
+#pragma once
+
+#include "Event.h"
+#include "MemoryResource.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace xwin
+{
+class Window;
+
+/**
+ * Runs per window event handlers on a fixed pool of worker threads, so one
+ * window's resize handling can run while another window renders, and slow
+ * handlers never hold up the thread reading events.
+ *
+ * Handlers are registered for a window and a mask of event types. Events for
+ * the same window are handled one at a time in the order they arrived, events
+ * for different windows run in parallel. Attach a dispatcher to an EventQueue
+ * with setDispatcher(), events are then still queued as usual.
+ *
+ * Queued calls are bounded by the capacity given on construction, and events
+ * dispatched while it's full are dropped and counted rather than blocking the
+ * event thread.
+ */
+class EventDispatcher
+{
+  public:
+    typedef std::function<void(const Event&)> Callback;
+
+    typedef unsigned Handler;
+
+    static const Handler InvalidHandler = 0;
+
+    static const size_t MaxHandlers = 64;
+
+    EventDispatcher(size_t workerCount = 2, size_t capacity = 1024,
+                    MemoryResource* resource = getDefaultMemoryResource());
+
+    // Stops the workers, calls still queued are discarded.
+    ~EventDispatcher();
+
+    EventDispatcher(const EventDispatcher&) = delete;
+    EventDispatcher& operator=(const EventDispatcher&) = delete;
+
+    // Call callback on a worker for every event of window whose type is in
+    // typeMask (bit i for EventType i). Returns InvalidHandler if MaxHandlers
+    // are registered.
+    Handler addHandler(Window* window, uint32_t typeMask, Callback callback);
+
+    // Once this returns the handler won't be called again, and isn't running
+    // unless it was removed from a handler itself.
+    void removeHandler(Handler handler);
+
+    // Remove every handler of a window, such as when it closes.
+    void removeWindow(Window* window);
+
+    // Queue calls for the handlers matching e, from the thread reading
+    // events. Returns false if any call was dropped.
+    bool dispatch(const Event& e);
+
+    // Block until every queued call has run.
+    void waitIdle();
+
+    // Calls dropped because the dispatcher was at capacity.
+    size_t getDropCount() const;
+
+    size_t getWorkerCount() const;
+
+  protected:
+    static const size_t None = ~(size_t)0;
+
+    struct Slot
+    {
+        Handler id = InvalidHandler;
+        uint32_t typeMask = 0;
+        bool removed = false;
+        size_t strand = None;
+        Callback callback;
+    };
+
+    // The queued calls for one window, run by at most one worker at a time.
+    struct Strand
+    {
+        Window* window = nullptr;
+        size_t handlers = 0;
+        size_t head = None;
+        size_t tail = None;
+        bool scheduled = false;
+        bool running = false;
+    };
+
+    struct Call
+    {
+        Event event;
+        Handler handler;
+        size_t slot;
+        size_t next;
+    };
+
+    void run();
+
+    // Find or claim the strand of a window.
+    size_t acquireStrand(Window* window);
+
+    // Free removed handlers of a strand that isn't running.
+    void releaseRemoved(size_t strand);
+
+    void schedule(size_t strand);
+
+    bool onWorker() const;
+
+    MemoryResource* mResource;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mWork;
+    std::condition_variable mIdle;
+    bool mStopping = false;
+
+    Slot mSlots[MaxHandlers];
+    Strand mStrands[MaxHandlers];
+    Handler mNextHandler = 1;
+
+    // Types any handler wants, so dispatch() can skip the lock for the rest.
+    std::atomic<uint32_t> mTypeMask;
+
+    // Strands with calls waiting for a worker
+    size_t mReady[MaxHandlers];
+    size_t mReadyHead = 0;
+    size_t mReadyCount = 0;
+
+    // A fixed pool of calls and its free list
+    Call* mCalls;
+    size_t mCapacity;
+    size_t mFree = None;
+    size_t mQueued = 0;
+    size_t mRunning = 0;
+
+    size_t mDrops = 0;
+
+    std::vector<std::thread> mWorkers;
+};
+}
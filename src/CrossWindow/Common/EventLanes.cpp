@@ -0,0 +1,518 @@
+#include "EventLanes.h"
+
+#include <chrono>
+
+namespace xwin
+{
+EventCategory getEventCategory(EventType type)
+{
+    switch (type)
+    {
+    case EventType::Keyboard:
+        return EventCategory::Keyboard;
+    case EventType::MouseMove:
+    case EventType::MouseRaw:
+    case EventType::MouseWheel:
+    case EventType::MouseInput:
+        return EventCategory::Pointer;
+    case EventType::Touch:
+        return EventCategory::Touch;
+    case EventType::Gamepad:
+        return EventCategory::Gamepad;
+    default:
+        return EventCategory::Window;
+    }
+}
+
+EventPriority getDefaultEventPriority(EventType type)
+{
+    switch (type)
+    {
+    case EventType::Close:
+    case EventType::Create:
+    case EventType::Focus:
+    case EventType::Resize:
+    case EventType::DPI:
+        return EventPriority::High;
+    case EventType::MouseMove:
+    case EventType::MouseRaw:
+    case EventType::Touch:
+    case EventType::Gamepad:
+        return EventPriority::Low;
+    default:
+        return EventPriority::Normal;
+    }
+}
+
+OverflowPolicy getDefaultOverflowPolicy(EventType type)
+{
+    switch (type)
+    {
+    case EventType::MouseMove:
+    case EventType::MouseRaw:
+        return OverflowPolicy::Coalesce;
+    case EventType::Touch:
+    case EventType::Gamepad:
+        return OverflowPolicy::DropOldest;
+    default:
+        return OverflowPolicy::Keep;
+    }
+}
+
+uint64_t getSteadyTimeNs()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+EventLanes::EventLanes(MemoryResource* resource)
+    : mLanes{{resource}, {resource}, {resource}},
+      mStreams{{resource}, {resource}, {resource}, {resource}, {resource}},
+      mPipelineSink(*this)
+{
+    for (size_t i = 0; i < CategoryCount; ++i)
+    {
+        mStreamEnabled[i] = false;
+    }
+    for (size_t i = 0; i < (size_t)EventType::EventTypeMax; ++i)
+    {
+        mPriorities[i] = getDefaultEventPriority((EventType)i);
+        mPolicies[i] = getDefaultOverflowPolicy((EventType)i);
+    }
+    resetOverflowCounts();
+}
+
+void EventLanes::setPriority(EventType type, EventPriority priority)
+{
+    if (type < EventType::EventTypeMax &&
+        priority < EventPriority::EventPriorityMax)
+    {
+        mPriorities[(size_t)type] = priority;
+    }
+}
+
+EventPriority EventLanes::getPriority(EventType type) const
+{
+    return type < EventType::EventTypeMax ? mPriorities[(size_t)type]
+                                          : EventPriority::Normal;
+}
+
+void EventLanes::setDrainOrder(DrainOrder order) { mDrainOrder = order; }
+
+DrainOrder EventLanes::getDrainOrder() const { return mDrainOrder; }
+
+void EventLanes::setCapacity(size_t capacity) { mCapacity = capacity; }
+
+size_t EventLanes::getCapacity() const { return mCapacity; }
+
+bool EventLanes::full() const { return mCapacity != 0 && mSize >= mCapacity; }
+
+void EventLanes::setOverflowPolicy(EventType type, OverflowPolicy policy)
+{
+    if (type < EventType::EventTypeMax &&
+        policy < OverflowPolicy::OverflowPolicyMax)
+    {
+        mPolicies[(size_t)type] = policy;
+    }
+}
+
+OverflowPolicy EventLanes::getOverflowPolicy(EventType type) const
+{
+    return type < EventType::EventTypeMax ? mPolicies[(size_t)type]
+                                          : OverflowPolicy::Keep;
+}
+
+void EventLanes::setBlockWhenFull(bool block) { mBlockWhenFull = block; }
+
+bool EventLanes::blocked() const { return mBlockWhenFull && full(); }
+
+size_t EventLanes::getDropCount(EventType type) const
+{
+    return type < EventType::EventTypeMax ? mDropCounts[(size_t)type] : 0;
+}
+
+size_t EventLanes::getCoalesceCount(EventType type) const
+{
+    return type < EventType::EventTypeMax ? mCoalesceCounts[(size_t)type] : 0;
+}
+
+void EventLanes::resetOverflowCounts()
+{
+    for (size_t i = 0; i < (size_t)EventType::EventTypeMax; ++i)
+    {
+        mDropCounts[i] = 0;
+        mCoalesceCounts[i] = 0;
+    }
+}
+
+bool EventLanes::coalesce(Event& target, const Event& e)
+{
+    switch (e.type)
+    {
+    case EventType::MouseMove:
+    {
+        MouseMoveData& move = target.data.mouseMove;
+        int deltax = move.deltax + e.data.mouseMove.deltax;
+        int deltay = move.deltay + e.data.mouseMove.deltay;
+        move = e.data.mouseMove;
+        move.deltax = deltax;
+        move.deltay = deltay;
+        return true;
+    }
+    case EventType::MouseRaw:
+        target.data.mouseRaw.deltax += e.data.mouseRaw.deltax;
+        target.data.mouseRaw.deltay += e.data.mouseRaw.deltay;
+        return true;
+    case EventType::MouseWheel:
+        target.data.mouseWheel.delta += e.data.mouseWheel.delta;
+        return true;
+    case EventType::Resize:
+    case EventType::DPI:
+    case EventType::Focus:
+    case EventType::Touch:
+    case EventType::Gamepad:
+        target = e;
+        return true;
+    default:
+        // Discrete events can't be summarized
+        return false;
+    }
+}
+
+bool EventLanes::makeRoom(const Event& e)
+{
+    OverflowPolicy policy = getOverflowPolicy(e.type);
+    if (policy == OverflowPolicy::Keep)
+    {
+        return true;
+    }
+
+    if (policy == OverflowPolicy::Coalesce)
+    {
+        // Only the newest queued event overall, so nothing queued after it
+        // in another lane ends up behind the merged event.
+        RingBuffer<Entry>& lane = mLanes[(size_t)getPriority(e.type)];
+        if (!lane.empty() && lane.back().sequence + 1 == mSequence)
+        {
+            Event& newest = lane.back().event;
+            if (newest.type == e.type && newest.window == e.window &&
+                coalesce(newest, e))
+            {
+                ++mCoalesceCounts[(size_t)e.type];
+                return false;
+            }
+        }
+    }
+
+    // Drop the oldest droppable event, starting with the lowest lane.
+    for (size_t i = LaneCount; i-- > 0;)
+    {
+        if (!mLanes[i].empty())
+        {
+            EventType type = mLanes[i].front().event.type;
+            if (getOverflowPolicy(type) != OverflowPolicy::Keep)
+            {
+                mLanes[i].pop();
+                --mSize;
+                ++mDropCounts[(size_t)type];
+                return true;
+            }
+        }
+    }
+
+    ++mDropCounts[(size_t)e.type];
+    return false;
+}
+
+void EventLanes::setStreamEnabled(EventCategory category, bool enabled)
+{
+    if (category < EventCategory::EventCategoryMax)
+    {
+        mStreamEnabled[(size_t)category] = enabled;
+    }
+}
+
+bool EventLanes::isStreamEnabled(EventCategory category) const
+{
+    return category < EventCategory::EventCategoryMax &&
+           mStreamEnabled[(size_t)category];
+}
+
+void EventLanes::setBroadcast(EventBroadcast* broadcast)
+{
+    mBroadcast = broadcast;
+}
+
+EventBroadcast* EventLanes::getBroadcast() const { return mBroadcast; }
+
+void EventLanes::setPipeline(EventProcessor* pipeline)
+{
+    mPipeline = pipeline;
+}
+
+EventProcessor* EventLanes::getPipeline() const { return mPipeline; }
+
+void EventLanes::setDispatcher(EventDispatcher* dispatcher)
+{
+    mDispatcher = dispatcher;
+}
+
+EventDispatcher* EventLanes::getDispatcher() const { return mDispatcher; }
+
+void EventLanes::push(const Event& e)
+{
+    if (mPipeline != nullptr)
+    {
+        mPipeline->process(e, mPipelineSink);
+        return;
+    }
+    enqueue(e);
+}
+
+void EventLanes::addWaiter(EventWaiter* waiter)
+{
+    if (waiter->waiting)
+    {
+        return;
+    }
+    waiter->timedOut = false;
+    waiter->prev = nullptr;
+    waiter->next = mWaiters;
+    if (mWaiters != nullptr)
+    {
+        mWaiters->prev = waiter;
+    }
+    mWaiters = waiter;
+    waiter->waiting = true;
+}
+
+void EventLanes::removeWaiter(EventWaiter* waiter)
+{
+    if (!waiter->waiting)
+    {
+        return;
+    }
+    if (waiter->prev != nullptr)
+    {
+        waiter->prev->next = waiter->next;
+    }
+    else
+    {
+        mWaiters = waiter->next;
+    }
+    if (waiter->next != nullptr)
+    {
+        waiter->next->prev = waiter->prev;
+    }
+    waiter->prev = nullptr;
+    waiter->next = nullptr;
+    waiter->waiting = false;
+}
+
+bool EventLanes::hasWaiters() const { return mWaiters != nullptr; }
+
+void EventLanes::wakeAll(EventWaiter* woken)
+{
+    // Waking may free the waiter (its coroutine can finish), so read the link
+    // first.
+    while (woken != nullptr)
+    {
+        EventWaiter* next = woken->next;
+        woken->next = nullptr;
+        woken->wake();
+        woken = next;
+    }
+}
+
+bool EventLanes::offerToWaiters(const Event& e)
+{
+    uint32_t bit = 1u << static_cast<size_t>(e.type);
+
+    // Unlink every match before waking any, so waiters added while waking
+    // wait for the next event rather than taking this one.
+    EventWaiter* woken = nullptr;
+    EventWaiter* waiter = mWaiters;
+    while (waiter != nullptr)
+    {
+        EventWaiter* next = waiter->next;
+        if ((waiter->typeMask & bit) != 0)
+        {
+            removeWaiter(waiter);
+            waiter->event = e;
+            waiter->next = woken;
+            woken = waiter;
+        }
+        waiter = next;
+    }
+    if (woken == nullptr)
+    {
+        return false;
+    }
+    wakeAll(woken);
+    return true;
+}
+
+void EventLanes::expireWaiters(uint64_t nowNs)
+{
+    EventWaiter* woken = nullptr;
+    EventWaiter* waiter = mWaiters;
+    while (waiter != nullptr)
+    {
+        EventWaiter* next = waiter->next;
+        if (waiter->deadlineNs != 0 && waiter->deadlineNs <= nowNs)
+        {
+            removeWaiter(waiter);
+            waiter->timedOut = true;
+            waiter->next = woken;
+            woken = waiter;
+        }
+        waiter = next;
+    }
+    wakeAll(woken);
+}
+
+uint64_t EventLanes::getNextWaiterDeadline() const
+{
+    uint64_t deadline = 0;
+    for (EventWaiter* waiter = mWaiters; waiter != nullptr;
+         waiter = waiter->next)
+    {
+        if (waiter->deadlineNs != 0 &&
+            (deadline == 0 || waiter->deadlineNs < deadline))
+        {
+            deadline = waiter->deadlineNs;
+        }
+    }
+    return deadline;
+}
+
+void EventLanes::enqueue(const Event& e)
+{
+    // Waiters take events before anything else sees them.
+    if (mWaiters != nullptr && offerToWaiters(e))
+    {
+        return;
+    }
+
+    if (mDispatcher != nullptr)
+    {
+        mDispatcher->dispatch(e);
+    }
+
+    if (mBroadcast != nullptr)
+    {
+        mBroadcast->publish(e);
+        return;
+    }
+
+    size_t category = (size_t)getEventCategory(e.type);
+    if (mStreamEnabled[category])
+    {
+        mStreams[category].push(e);
+        return;
+    }
+    if (full() && !makeRoom(e))
+    {
+        return;
+    }
+    mLanes[(size_t)getPriority(e.type)].emplace(e, mSequence++);
+    ++mSize;
+}
+
+RingBuffer<EventLanes::Entry>& EventLanes::next()
+{
+    // Only the High lane jumps the queue. Normal and Low stay merged in
+    // arrival order, so a button press, the motion after it and its release
+    // come out in the order they happened.
+    RingBuffer<Entry>& high = mLanes[(size_t)EventPriority::High];
+    if (mDrainOrder == DrainOrder::Priority && !high.empty())
+    {
+        return high;
+    }
+
+    RingBuffer<Entry>* lane = nullptr;
+    for (size_t i = 0; i < LaneCount; ++i)
+    {
+        if (mLanes[i].empty())
+        {
+            continue;
+        }
+        if (lane == nullptr ||
+            mLanes[i].front().sequence < lane->front().sequence)
+        {
+            lane = &mLanes[i];
+        }
+    }
+    return *lane;
+}
+
+const Event& EventLanes::front() { return next().front().event; }
+
+void EventLanes::pop()
+{
+    next().pop();
+    --mSize;
+}
+
+bool EventLanes::empty() const { return mSize == 0; }
+
+size_t EventLanes::size() const { return mSize; }
+
+size_t EventLanes::size(EventPriority priority) const
+{
+    return priority < EventPriority::EventPriorityMax
+               ? mLanes[(size_t)priority].size()
+               : 0;
+}
+
+const Event& EventLanes::front(EventCategory category)
+{
+    return mStreams[(size_t)category].front();
+}
+
+void EventLanes::pop(EventCategory category)
+{
+    mStreams[(size_t)category].pop();
+}
+
+bool EventLanes::empty(EventCategory category) const
+{
+    return category >= EventCategory::EventCategoryMax ||
+           mStreams[(size_t)category].empty();
+}
+
+size_t EventLanes::size(EventCategory category) const
+{
+    return category < EventCategory::EventCategoryMax
+               ? mStreams[(size_t)category].size()
+               : 0;
+}
+
+void EventLanes::reserve(size_t capacity)
+{
+    for (size_t i = 0; i < LaneCount; ++i)
+    {
+        mLanes[i].reserve(capacity);
+    }
+}
+
+void EventLanes::clear()
+{
+    for (size_t i = 0; i < LaneCount; ++i)
+    {
+        mLanes[i].clear();
+    }
+    for (size_t i = 0; i < CategoryCount; ++i)
+    {
+        mStreams[i].clear();
+    }
+    mSize = 0;
+}
+
+MemoryResource* EventLanes::getResource() const
+{
+    return mLanes[0].getResource();
+}
+}
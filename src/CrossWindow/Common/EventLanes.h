@@ -0,0 +1,323 @@
+#pragma once
+
+#include "Event.h"
+#include "EventBroadcast.h"
+#include "EventDispatcher.h"
+#include "EventPipeline.h"
+#include "MemoryResource.h"
+#include "RingBuffer.h"
+
+#include <stdint.h>
+#include <utility>
+
+/**
+ * Priority lanes for event queues.
+ *
+ * Every EventType is assigned a lane. By default window state changes
+ * (Close, Create, Focus, Resize, DPI) go in the High lane, discrete input
+ * (keys, buttons, wheel, file drops, paint) in the Normal lane, and
+ * continuous input (mouse motion, raw mouse, touch, gamepad) in the Low lane,
+ * so a flood of motion can't delay a Close.
+ *
+ * Lanes can also be bounded. Once the capacity is reached each event type's
+ * OverflowPolicy decides what happens, so memory use and the latency of
+ * catching up after a stall stay bounded.
+ *
+ * Subsystems that only care about one category of event (the UI wants
+ * keyboard input, the camera wants pointer motion) can enable a stream for
+ * that category. Its events then skip the lanes and go to a queue of their
+ * own, which the subsystem drains without scanning anything else.
+ */
+namespace xwin
+{
+enum class EventPriority : uint8_t
+{
+    High = 0,
+    Normal,
+    Low,
+    EventPriorityMax
+};
+
+enum class DrainOrder
+{
+    // Events come out in the order they arrived, regardless of lane.
+    Arrival,
+
+    // Events in the High lane come out first. Normal and Low events come out
+    // after them in the order they arrived, so input keeps its relative
+    // order across those two lanes.
+    Priority,
+
+    DrainOrderMax
+};
+
+enum class OverflowPolicy
+{
+    // Always queue the event, even past capacity.
+    Keep,
+
+    // Make room by dropping the oldest droppable (not Keep) event, or drop
+    // this event if there's nothing else to drop.
+    DropOldest,
+
+    // Merge into the newest queued event if it's of the same type and window
+    // (motion deltas and wheel deltas accumulate, state events take the
+    // latest value), falling back to DropOldest. Merging into anything older
+    // would move the event ahead of those queued since.
+    Coalesce,
+
+    OverflowPolicyMax
+};
+
+enum class EventCategory : uint8_t
+{
+    // Window state, paint, file drop, timer and fd source events
+    Window = 0,
+
+    Keyboard,
+
+    // Mouse motion, raw mouse, wheel and buttons
+    Pointer,
+
+    Touch,
+
+    Gamepad,
+
+    EventCategoryMax
+};
+
+EventCategory getEventCategory(EventType type);
+
+// The lane an event type uses unless reassigned.
+EventPriority getDefaultEventPriority(EventType type);
+
+// Coalesce mouse motion, DropOldest touch and gamepad, Keep everything else.
+OverflowPolicy getDefaultOverflowPolicy(EventType type);
+
+// std::chrono::steady_clock in nanoseconds, the clock waiter deadlines use.
+uint64_t getSteadyTimeNs();
+
+/**
+ * Something waiting for the next event of some types, such as a suspended
+ * coroutine (see EventAwaitables.h). Waiters are linked into the lanes
+ * intrusively so waiting never allocates.
+ */
+class EventWaiter
+{
+  public:
+    virtual ~EventWaiter() {}
+
+    // Called once the waiter has been handed an event, or timed out.
+    virtual void wake() = 0;
+
+    // Bit i set waits for EventType i.
+    uint32_t typeMask = 0;
+
+    // steady_clock nanoseconds to give up at, 0 waits forever.
+    uint64_t deadlineNs = 0;
+
+    Event event;
+    bool timedOut = false;
+
+    EventWaiter* prev = nullptr;
+    EventWaiter* next = nullptr;
+    bool waiting = false;
+};
+
+class EventLanes
+{
+  public:
+    EventLanes(MemoryResource* resource = getDefaultMemoryResource());
+
+    void setPriority(EventType type, EventPriority priority);
+
+    EventPriority getPriority(EventType type) const;
+
+    void setDrainOrder(DrainOrder order);
+
+    DrainOrder getDrainOrder() const;
+
+    // Maximum number of queued events before overflow policies apply, 0 (the
+    // default) is unbounded.
+    void setCapacity(size_t capacity);
+
+    size_t getCapacity() const;
+
+    bool full() const;
+
+    void setOverflowPolicy(EventType type, OverflowPolicy policy);
+
+    OverflowPolicy getOverflowPolicy(EventType type) const;
+
+    // When set, backends stop reading from the OS while the lanes are full,
+    // leaving events with the OS until the consumer catches up.
+    void setBlockWhenFull(bool block);
+
+    // True when the producer should stop reading events.
+    bool blocked() const;
+
+    // Events of a type dropped, or merged into another, since the last reset.
+    size_t getDropCount(EventType type) const;
+
+    size_t getCoalesceCount(EventType type) const;
+
+    void resetOverflowCounts();
+
+    // Route a category's events to its own stream instead of the lanes.
+    void setStreamEnabled(EventCategory category, bool enabled);
+
+    bool isStreamEnabled(EventCategory category) const;
+
+    // Publish every event to a broadcast ring instead of queueing it, nullptr
+    // to stop.
+    void setBroadcast(EventBroadcast* broadcast);
+
+    EventBroadcast* getBroadcast() const;
+
+    // Run every event through a pipeline of stages before queueing it,
+    // nullptr to stop.
+    void setPipeline(EventProcessor* pipeline);
+
+    EventProcessor* getPipeline() const;
+
+    // Hand every event to a dispatcher's handlers as it's queued, nullptr to
+    // stop.
+    void setDispatcher(EventDispatcher* dispatcher);
+
+    EventDispatcher* getDispatcher() const;
+
+    // Hand the next matching event to a waiter instead of queueing it. A
+    // waiter is woken at most once, then removed.
+    void addWaiter(EventWaiter* waiter);
+
+    void removeWaiter(EventWaiter* waiter);
+
+    bool hasWaiters() const;
+
+    // Time out waiters whose deadline has passed.
+    void expireWaiters(uint64_t nowNs = getSteadyTimeNs());
+
+    // The earliest waiter deadline, 0 if none have one.
+    uint64_t getNextWaiterDeadline() const;
+
+    // Queue an event, through the pipeline if set. Then to the broadcast ring
+    // if set, to its category's stream
+    // if enabled, otherwise to its lane, applying its overflow policy if the
+    // lanes are full.
+    void push(const Event& e);
+
+    template <typename... Args> void emplace(Args&&... args)
+    {
+        push(Event(std::forward<Args>(args)...));
+    }
+
+    const Event& front();
+
+    void pop();
+
+    bool empty() const;
+
+    size_t size() const;
+
+    // Events waiting in a single lane.
+    size_t size(EventPriority priority) const;
+
+    // The oldest event in a category's stream.
+    const Event& front(EventCategory category);
+
+    void pop(EventCategory category);
+
+    bool empty(EventCategory category) const;
+
+    size_t size(EventCategory category) const;
+
+    // Preallocate room for this many events in every lane.
+    void reserve(size_t capacity);
+
+    void clear();
+
+    MemoryResource* getResource() const;
+
+  protected:
+    struct Entry
+    {
+        Entry(const Event& event, uint64_t sequence)
+            : event(event), sequence(sequence)
+        {
+        }
+
+        Event event;
+
+        // Arrival order across lanes
+        uint64_t sequence;
+    };
+
+    static const size_t LaneCount = (size_t)EventPriority::EventPriorityMax;
+
+    static const size_t CategoryCount =
+        (size_t)EventCategory::EventCategoryMax;
+
+    // The lane front() and pop() currently refer to.
+    RingBuffer<Entry>& next();
+
+    // Queue an event that has been through the pipeline.
+    void enqueue(const Event& e);
+
+    // Wake every waiter for e, returns false if there were none.
+    bool offerToWaiters(const Event& e);
+
+    // Wake a list of waiters unlinked from mWaiters.
+    static void wakeAll(EventWaiter* woken);
+
+    // Feeds the pipeline's output back into the lanes.
+    class PipelineSink : public EventSink
+    {
+      public:
+        PipelineSink(EventLanes& lanes) : mLanes(lanes) {}
+
+        void operator()(const Event& e) override { mLanes.enqueue(e); }
+
+      protected:
+        EventLanes& mLanes;
+    };
+
+    // Apply e's overflow policy, returns false if e was merged or dropped.
+    bool makeRoom(const Event& e);
+
+    static bool coalesce(Event& target, const Event& e);
+
+    RingBuffer<Entry> mLanes[LaneCount];
+
+    RingBuffer<Event> mStreams[CategoryCount];
+
+    bool mStreamEnabled[CategoryCount];
+
+    EventBroadcast* mBroadcast = nullptr;
+
+    EventProcessor* mPipeline = nullptr;
+
+    EventDispatcher* mDispatcher = nullptr;
+
+    EventWaiter* mWaiters = nullptr;
+
+    PipelineSink mPipelineSink;
+
+    EventPriority mPriorities[(size_t)EventType::EventTypeMax];
+
+    OverflowPolicy mPolicies[(size_t)EventType::EventTypeMax];
+
+    size_t mDropCounts[(size_t)EventType::EventTypeMax];
+
+    size_t mCoalesceCounts[(size_t)EventType::EventTypeMax];
+
+    size_t mCapacity = 0;
+
+    bool mBlockWhenFull = false;
+
+    DrainOrder mDrainOrder = DrainOrder::Arrival;
+
+    uint64_t mSequence = 0;
+
+    size_t mSize = 0;
+};
+}
@@ -0,0 +1,41 @@
+#include "EventMailbox.h"
+
+namespace xwin
+{
+EventMailbox::EventMailbox(MemoryResource* resource)
+    : mPosted(resource), mDraining(resource), mHasPosted(false)
+{
+}
+
+bool EventMailbox::post(const Event& e)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    bool wasEmpty = mPosted.empty();
+    mPosted.push(e);
+    mHasPosted.store(true, std::memory_order_release);
+    return wasEmpty;
+}
+
+void EventMailbox::drain(EventLanes& lanes)
+{
+    if (!mHasPosted.load(std::memory_order_acquire))
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mPosted.swap(mDraining);
+        mHasPosted.store(false, std::memory_order_relaxed);
+    }
+    while (!mDraining.empty())
+    {
+        lanes.push(mDraining.front());
+        mDraining.pop();
+    }
+}
+
+bool EventMailbox::hasPosted() const
+{
+    return mHasPosted.load(std::memory_order_acquire);
+}
+}
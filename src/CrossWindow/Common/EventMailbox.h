@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Event.h"
+#include "EventLanes.h"
+#include "MemoryResource.h"
+#include "RingBuffer.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace xwin
+{
+/**
+ * Events posted from other threads, waiting to be moved into an EventQueue by
+ * its own thread on the next update.
+ */
+class EventMailbox
+{
+  public:
+    EventMailbox(MemoryResource* resource = getDefaultMemoryResource());
+
+    // Safe from any thread. Returns true if the mailbox was empty, meaning the
+    // owning queue should be woken.
+    bool post(const Event& e);
+
+    // Move every posted event into the lanes, from the owning thread. The
+    // lock isn't held while pushing, so pipelines and dispatch handlers can
+    // post, their events arrive on the next drain.
+    void drain(EventLanes& lanes);
+
+    bool hasPosted() const;
+
+  protected:
+    std::mutex mMutex;
+    RingBuffer<Event> mPosted;
+
+    // Swapped with mPosted by drain(), so both keep their storage
+    RingBuffer<Event> mDraining;
+
+    // Lets drain() skip the lock when nothing was posted
+    std::atomic<bool> mHasPosted;
+};
+}
@@ -0,0 +1,67 @@
+#include "EventPipeline.h"
+
+namespace xwin
+{
+void EventStage::Next::operator()(const Event& e)
+{
+    mPipeline.run(mIndex, e, mSink);
+}
+
+bool EventPipeline::addStage(EventStage* stage)
+{
+    return insertStage(mCount, stage);
+}
+
+bool EventPipeline::insertStage(size_t index, EventStage* stage)
+{
+    if (stage == nullptr || mCount == MaxStages || index > mCount)
+    {
+        return false;
+    }
+    for (size_t i = mCount; i > index; --i)
+    {
+        mStages[i] = mStages[i - 1];
+    }
+    mStages[index] = stage;
+    ++mCount;
+    return true;
+}
+
+void EventPipeline::removeStage(EventStage* stage)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < mCount; ++i)
+    {
+        if (mStages[i] != stage)
+        {
+            mStages[count++] = mStages[i];
+        }
+    }
+    mCount = count;
+}
+
+void EventPipeline::clear() { mCount = 0; }
+
+size_t EventPipeline::getStageCount() const { return mCount; }
+
+EventStage* EventPipeline::getStage(size_t index) const
+{
+    return index < mCount ? mStages[index] : nullptr;
+}
+
+void EventPipeline::process(const Event& e, EventSink& sink)
+{
+    run(0, e, sink);
+}
+
+void EventPipeline::run(size_t index, const Event& e, EventSink& sink)
+{
+    if (index == mCount)
+    {
+        sink(e);
+        return;
+    }
+    EventStage::Next next(*this, index + 1, sink);
+    mStages[index]->process(e, next);
+}
+}
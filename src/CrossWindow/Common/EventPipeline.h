@@ -0,0 +1,311 @@
+#pragma once
+
+#include "Event.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+/**
+ * Event processing pipelines, ordered stages that sit between a backend
+ * decoding an event and the event being queued. A stage can transform an
+ * event, drop it (by not passing it on) or split it (by passing on several).
+ *
+ * A stage is any type with a method
+ *
+ *     template <typename Next> void process(const Event& e, Next& next);
+ *
+ * that calls next(event) zero or more times. Stages are composed either at
+ * compile time with StaticEventPipeline, where the whole chain is inlined
+ * with no virtual calls, or at runtime with EventPipeline, a fixed size array
+ * of stages that can be changed between updates. Either is handed to an
+ * EventQueue with setPipeline(), which costs one virtual call per event.
+ */
+namespace xwin
+{
+// Where the last stage of a pipeline sends events.
+class EventSink
+{
+  public:
+    virtual ~EventSink() {}
+
+    virtual void operator()(const Event& e) = 0;
+};
+
+// Anything an EventQueue can run its decoded events through.
+class EventProcessor
+{
+  public:
+    virtual ~EventProcessor() {}
+
+    virtual void process(const Event& e, EventSink& sink) = 0;
+};
+
+/**
+ * Stages composed at compile time, StaticEventPipeline<A, B, C> runs each
+ * event through A, then B, then C.
+ */
+template <typename... Stages> class StaticEventPipeline;
+
+template <> class StaticEventPipeline<> : public EventProcessor
+{
+  public:
+    template <typename Sink> void run(const Event& e, Sink& sink) { sink(e); }
+
+    void process(const Event& e, EventSink& sink) override { run(e, sink); }
+};
+
+template <typename First, typename... Rest>
+class StaticEventPipeline<First, Rest...> : public EventProcessor
+{
+  public:
+    StaticEventPipeline() {}
+
+    StaticEventPipeline(First first, Rest... rest)
+        : mFirst(std::move(first)), mRest(std::move(rest)...)
+    {
+    }
+
+    // Run an event through every stage, sink receives whatever comes out.
+    template <typename Sink> void run(const Event& e, Sink& sink)
+    {
+        Next<Sink> next = {mRest, sink};
+        mFirst.process(e, next);
+    }
+
+    void process(const Event& e, EventSink& sink) override { run(e, sink); }
+
+    First& getStage() { return mFirst; }
+
+    // The pipeline after the first stage.
+    StaticEventPipeline<Rest...>& getRest() { return mRest; }
+
+  protected:
+    template <typename Sink> struct Next
+    {
+        StaticEventPipeline<Rest...>& rest;
+        Sink& sink;
+
+        void operator()(const Event& e) { rest.run(e, sink); }
+    };
+
+    First mFirst;
+    StaticEventPipeline<Rest...> mRest;
+};
+
+class EventPipeline;
+
+/**
+ * A stage of a runtime EventPipeline.
+ */
+class EventStage
+{
+  public:
+    // Passes an event on to the rest of a runtime pipeline.
+    class Next
+    {
+      public:
+        Next(EventPipeline& pipeline, size_t index, EventSink& sink)
+            : mPipeline(pipeline), mIndex(index), mSink(sink)
+        {
+        }
+
+        void operator()(const Event& e);
+
+      protected:
+        EventPipeline& mPipeline;
+        size_t mIndex;
+        EventSink& mSink;
+    };
+
+    virtual ~EventStage() {}
+
+    virtual void process(const Event& e, Next& next) = 0;
+};
+
+/**
+ * Wraps a static stage type so it can be used in a runtime pipeline.
+ */
+template <typename Stage> class EventStageAdapter : public EventStage
+{
+  public:
+    template <typename... Args>
+    EventStageAdapter(Args&&... args) : mStage(std::forward<Args>(args)...)
+    {
+    }
+
+    void process(const Event& e, Next& next) override
+    {
+        mStage.process(e, next);
+    }
+
+    Stage& getStage() { return mStage; }
+
+  protected:
+    Stage mStage;
+};
+
+/**
+ * Stages composed at runtime. Stages are borrowed, not owned, and run in the
+ * order they were added.
+ */
+class EventPipeline : public EventProcessor
+{
+  public:
+    static const size_t MaxStages = 16;
+
+    // Returns false if the pipeline already has MaxStages stages.
+    bool addStage(EventStage* stage);
+
+    // Insert a stage before the stage at index.
+    bool insertStage(size_t index, EventStage* stage);
+
+    void removeStage(EventStage* stage);
+
+    void clear();
+
+    size_t getStageCount() const;
+
+    EventStage* getStage(size_t index) const;
+
+    void process(const Event& e, EventSink& sink) override;
+
+  protected:
+    friend class EventStage::Next;
+
+    void run(size_t index, const Event& e, EventSink& sink);
+
+    EventStage* mStages[MaxStages];
+    size_t mCount = 0;
+};
+
+/**
+ * Zeroes gamepad axes within a dead zone, rescaling the rest to the full
+ * [-1, 1] range.
+ */
+class GamepadDeadZone
+{
+  public:
+    GamepadDeadZone(double deadZone = 0.1) : mDeadZone(deadZone) {}
+
+    template <typename Next> void process(const Event& e, Next& next)
+    {
+        if (e.type != EventType::Gamepad)
+        {
+            next(e);
+            return;
+        }
+        Event filtered = e;
+        GamepadData& gamepad = filtered.data.gamepad;
+        for (unsigned i = 0; i < gamepad.numAxes && i < 64; ++i)
+        {
+            double value = gamepad.axis[i];
+            double magnitude = value < 0.0 ? -value : value;
+            gamepad.axis[i] =
+                magnitude <= mDeadZone
+                    ? 0.0
+                    : (value < 0.0 ? -1.0 : 1.0) * (magnitude - mDeadZone) /
+                          (1.0 - mDeadZone);
+        }
+        next(filtered);
+    }
+
+    void setDeadZone(double deadZone) { mDeadZone = deadZone; }
+
+  protected:
+    double mDeadZone;
+};
+
+/**
+ * Remaps keyboard keys, such as for user configurable bindings.
+ */
+class KeyRemap
+{
+  public:
+    KeyRemap()
+    {
+        for (size_t i = 0; i < static_cast<size_t>(Key::KeysMax); ++i)
+        {
+            mMap[i] = static_cast<Key>(i);
+        }
+    }
+
+    void setMapping(Key from, Key to)
+    {
+        if (from < Key::KeysMax)
+        {
+            mMap[static_cast<size_t>(from)] = to;
+        }
+    }
+
+    template <typename Next> void process(const Event& e, Next& next)
+    {
+        if (e.type != EventType::Keyboard ||
+            e.data.keyboard.key >= Key::KeysMax)
+        {
+            next(e);
+            return;
+        }
+        Key key = mMap[static_cast<size_t>(e.data.keyboard.key)];
+        if (key == e.data.keyboard.key)
+        {
+            next(e);
+            return;
+        }
+        Event remapped = e;
+        remapped.data.keyboard.key = key;
+        next(remapped);
+    }
+
+  protected:
+    Key mMap[static_cast<size_t>(Key::KeysMax)];
+};
+
+/**
+ * Drops events of the given types.
+ */
+class EventTypeFilter
+{
+    static_assert(static_cast<size_t>(EventType::EventTypeMax) <= 32,
+                  "EventTypeFilter stores event types in a 32 bit mask");
+
+  public:
+    void setDropped(EventType type, bool dropped)
+    {
+        uint32_t bit = 1u << static_cast<size_t>(type);
+        mDropped = dropped ? (mDropped | bit) : (mDropped & ~bit);
+    }
+
+    template <typename Next> void process(const Event& e, Next& next)
+    {
+        if ((mDropped & (1u << static_cast<size_t>(e.type))) == 0)
+        {
+            next(e);
+        }
+    }
+
+  protected:
+    uint32_t mDropped = 0;
+};
+
+/**
+ * Hands every event that reaches it to a callable (such as a logger or an
+ * EventRecorder) and passes it on unchanged.
+ */
+template <typename Callback> class EventTap
+{
+  public:
+    EventTap(Callback callback = Callback()) : mCallback(std::move(callback))
+    {
+    }
+
+    template <typename Next> void process(const Event& e, Next& next)
+    {
+        mCallback(e);
+        next(e);
+    }
+
+  protected:
+    Callback mCallback;
+};
+}
@@ -0,0 +1,131 @@
+#include "EventQueueBase.h"
+
+namespace xwin
+{
+EventQueueBase::EventQueueBase(MemoryResource* resource) : mQueue(resource) {}
+
+const Event& EventQueueBase::front() { return mQueue.front(); }
+
+void EventQueueBase::pop() { mQueue.pop(); }
+
+bool EventQueueBase::empty() { return mQueue.empty(); }
+
+size_t EventQueueBase::size() { return mQueue.size(); }
+
+void EventQueueBase::reserve(size_t capacity) { mQueue.reserve(capacity); }
+
+MemoryResource* EventQueueBase::getMemoryResource() const
+{
+    return mQueue.getResource();
+}
+
+void EventQueueBase::setPriority(EventType type, EventPriority priority)
+{
+    mQueue.setPriority(type, priority);
+}
+
+EventPriority EventQueueBase::getPriority(EventType type) const
+{
+    return mQueue.getPriority(type);
+}
+
+void EventQueueBase::setDrainOrder(DrainOrder order)
+{
+    mQueue.setDrainOrder(order);
+}
+
+DrainOrder EventQueueBase::getDrainOrder() const { return mQueue.getDrainOrder(); }
+
+size_t EventQueueBase::size(EventPriority priority)
+{
+    return mQueue.size(priority);
+}
+
+void EventQueueBase::setCapacity(size_t capacity) { mQueue.setCapacity(capacity); }
+
+size_t EventQueueBase::getCapacity() const { return mQueue.getCapacity(); }
+
+void EventQueueBase::setOverflowPolicy(EventType type, OverflowPolicy policy)
+{
+    mQueue.setOverflowPolicy(type, policy);
+}
+
+OverflowPolicy EventQueueBase::getOverflowPolicy(EventType type) const
+{
+    return mQueue.getOverflowPolicy(type);
+}
+
+void EventQueueBase::setBlockWhenFull(bool block)
+{
+    mQueue.setBlockWhenFull(block);
+}
+
+size_t EventQueueBase::getDropCount(EventType type) const
+{
+    return mQueue.getDropCount(type);
+}
+
+size_t EventQueueBase::getCoalesceCount(EventType type) const
+{
+    return mQueue.getCoalesceCount(type);
+}
+
+void EventQueueBase::resetOverflowCounts() { mQueue.resetOverflowCounts(); }
+
+void EventQueueBase::setStreamEnabled(EventCategory category, bool enabled)
+{
+    mQueue.setStreamEnabled(category, enabled);
+}
+
+bool EventQueueBase::isStreamEnabled(EventCategory category) const
+{
+    return mQueue.isStreamEnabled(category);
+}
+
+const Event& EventQueueBase::front(EventCategory category)
+{
+    return mQueue.front(category);
+}
+
+void EventQueueBase::pop(EventCategory category) { mQueue.pop(category); }
+
+bool EventQueueBase::empty(EventCategory category)
+{
+    return mQueue.empty(category);
+}
+
+size_t EventQueueBase::size(EventCategory category)
+{
+    return mQueue.size(category);
+}
+
+void EventQueueBase::setBroadcast(EventBroadcast* broadcast)
+{
+    mQueue.setBroadcast(broadcast);
+}
+
+EventBroadcast* EventQueueBase::getBroadcast() const
+{
+    return mQueue.getBroadcast();
+}
+
+void EventQueueBase::setPipeline(EventProcessor* pipeline)
+{
+    mQueue.setPipeline(pipeline);
+}
+
+EventProcessor* EventQueueBase::getPipeline() const
+{
+    return mQueue.getPipeline();
+}
+
+void EventQueueBase::setDispatcher(EventDispatcher* dispatcher)
+{
+    mQueue.setDispatcher(dispatcher);
+}
+
+EventDispatcher* EventQueueBase::getDispatcher() const
+{
+    return mQueue.getDispatcher();
+}
+}
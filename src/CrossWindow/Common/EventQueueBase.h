@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Event.h"
+#include "EventAwaitables.h"
+#include "EventLanes.h"
+#include "MemoryResource.h"
+
+namespace xwin
+{
+/**
+ * The part of every backend's EventQueue that reads and configures its
+ * EventLanes: draining, lanes, overflow, streams, fan out and coroutine
+ * awaitables. Backends derive from it and only add how events arrive.
+ */
+class EventQueueBase
+{
+  public:
+    const Event& front();
+
+    void pop();
+
+    bool empty();
+
+    size_t size();
+
+    // Preallocate room for this many queued events.
+    void reserve(size_t capacity);
+
+    MemoryResource* getMemoryResource() const;
+
+    // Choose which lane each event type is queued in.
+    void setPriority(EventType type, EventPriority priority);
+
+    EventPriority getPriority(EventType type) const;
+
+    // Arrival (the default) or Priority, draining higher lanes first.
+    void setDrainOrder(DrainOrder order);
+
+    DrainOrder getDrainOrder() const;
+
+    // Events waiting in a single lane.
+    size_t size(EventPriority priority);
+
+    // Bound the queue to this many events, 0 (the default) is unbounded.
+    void setCapacity(size_t capacity);
+
+    size_t getCapacity() const;
+
+    // What to do with events of a type that arrive while the queue is full.
+    void setOverflowPolicy(EventType type, OverflowPolicy policy);
+
+    OverflowPolicy getOverflowPolicy(EventType type) const;
+
+    // Stop reading OS events while the queue is full instead of applying
+    // overflow policies, so they wait in the OS queue.
+    void setBlockWhenFull(bool block);
+
+    // Events dropped, or merged into a newer event, since the last reset.
+    size_t getDropCount(EventType type) const;
+
+    size_t getCoalesceCount(EventType type) const;
+
+    void resetOverflowCounts();
+
+    // Give a category of events its own stream, they no longer appear in
+    // front()/pop() and are read with the category overloads instead.
+    void setStreamEnabled(EventCategory category, bool enabled);
+
+    bool isStreamEnabled(EventCategory category) const;
+
+    const Event& front(EventCategory category);
+
+    void pop(EventCategory category);
+
+    bool empty(EventCategory category);
+
+    size_t size(EventCategory category);
+
+    // Publish every event to a broadcast ring, read by any number of
+    // consumers, instead of queueing it. nullptr goes back to queueing.
+    void setBroadcast(EventBroadcast* broadcast);
+
+    EventBroadcast* getBroadcast() const;
+
+    // Run every decoded event through a pipeline of stages (see
+    // EventPipeline.h) before it's queued, nullptr to stop.
+    void setPipeline(EventProcessor* pipeline);
+
+    EventProcessor* getPipeline() const;
+
+    // Call handlers registered with a dispatcher (see EventDispatcher.h) on
+    // its worker threads as events are queued, nullptr to stop.
+    void setDispatcher(EventDispatcher* dispatcher);
+
+    EventDispatcher* getDispatcher() const;
+
+#if XWIN_HAS_COROUTINES
+    // co_await the payload of the next event of a type, such as
+    // next<KeyboardData>(). The event is handed to the coroutine instead of
+    // being queued, and it resumes inside update().
+    template <typename T> EventAwaitable<T, false> next()
+    {
+        return EventAwaitable<T, false>(mQueue, getEventTypeMask(T::type),
+                                        std::chrono::nanoseconds(0));
+    }
+
+    // As next(), resuming with an empty optional if update() runs after the
+    // timeout passes.
+    template <typename T>
+    EventAwaitable<T, true> next(std::chrono::nanoseconds timeout)
+    {
+        return EventAwaitable<T, true>(mQueue, getEventTypeMask(T::type),
+                                       timeout);
+    }
+
+    // co_await the next event of a type, or of any type in a mask from
+    // getEventTypeMask().
+    EventAwaitable<Event, false> any(EventType type)
+    {
+        return any(getEventTypeMask(type));
+    }
+
+    EventAwaitable<Event, true> any(EventType type,
+                                    std::chrono::nanoseconds timeout)
+    {
+        return any(getEventTypeMask(type), timeout);
+    }
+
+    EventAwaitable<Event, false> any(uint32_t typeMask)
+    {
+        return EventAwaitable<Event, false>(mQueue, typeMask,
+                                            std::chrono::nanoseconds(0));
+    }
+
+    EventAwaitable<Event, true> any(uint32_t typeMask,
+                                    std::chrono::nanoseconds timeout)
+    {
+        return EventAwaitable<Event, true>(mQueue, typeMask, timeout);
+    }
+#endif
+
+  protected:
+    // Internal storage is allocated from the given memory resource.
+    EventQueueBase(MemoryResource* resource);
+
+    EventLanes mQueue;
+};
+}
@@ -0,0 +1,808 @@
+#include "EventRecording.h"
+
+#include <chrono>
+#include <string.h>
+
+namespace xwin
+{
+namespace
+{
+const char sMagic[4] = {'X', 'W', 'E', 'V'};
+
+// Flush the write buffer to disk once it grows past this size.
+const size_t sFlushSize = 64 * 1024;
+
+const size_t sMaxAxes = sizeof(GamepadData::axis) / sizeof(double);
+const size_t sMaxButtons = sizeof(GamepadData::digitalButton) / sizeof(bool);
+const size_t sMaxTouches = sizeof(TouchData::touches) / sizeof(TouchPoint);
+
+uint64_t getMicroseconds()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+uint64_t zigzag(int64_t v)
+{
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t unzigzag(uint64_t v)
+{
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+uint8_t packModifiers(const ModifierState& m)
+{
+    return static_cast<uint8_t>((m.ctrl ? 1 : 0) | (m.alt ? 2 : 0) |
+                                (m.shift ? 4 : 0) | (m.meta ? 8 : 0));
+}
+
+ModifierState unpackModifiers(uint8_t bits)
+{
+    return ModifierState((bits & 1) != 0, (bits & 2) != 0, (bits & 4) != 0,
+                         (bits & 8) != 0);
+}
+
+/**
+ * Little endian writer over a byte vector.
+ */
+struct Writer
+{
+    std::vector<uint8_t>& out;
+
+    void u8(uint8_t v) { out.push_back(v); }
+
+    void varint(uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    void svarint(int64_t v) { varint(zigzag(v)); }
+
+    void u16(uint16_t v)
+    {
+        u8(static_cast<uint8_t>(v));
+        u8(static_cast<uint8_t>(v >> 8));
+    }
+
+    void u64(uint64_t v)
+    {
+        for (unsigned i = 0; i < 8; ++i)
+        {
+            u8(static_cast<uint8_t>(v >> (i * 8)));
+        }
+    }
+
+    void f64(double v)
+    {
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        u64(bits);
+    }
+
+    void f32(float v)
+    {
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            u8(static_cast<uint8_t>(bits >> (i * 8)));
+        }
+    }
+
+    // Strings are stored as length + 1 so that a null pointer round trips.
+    void str(const char* s)
+    {
+        if (s == nullptr)
+        {
+            varint(0);
+            return;
+        }
+        size_t len = strlen(s);
+        varint(len + 1);
+        out.insert(out.end(), s, s + len);
+    }
+};
+
+/**
+ * Bounds checked reader, any overrun latches the failed flag.
+ */
+struct Reader
+{
+    const std::vector<uint8_t>& in;
+    size_t& cursor;
+    bool failed = false;
+
+    Reader(const std::vector<uint8_t>& in, size_t& cursor)
+        : in(in), cursor(cursor)
+    {
+    }
+
+    uint8_t u8()
+    {
+        if (cursor >= in.size())
+        {
+            failed = true;
+            return 0;
+        }
+        return in[cursor++];
+    }
+
+    uint64_t varint()
+    {
+        uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7)
+        {
+            uint8_t b = u8();
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if ((b & 0x80) == 0 || failed)
+            {
+                return v;
+            }
+        }
+        failed = true;
+        return v;
+    }
+
+    int64_t svarint() { return unzigzag(varint()); }
+
+    uint16_t u16()
+    {
+        uint16_t lo = u8();
+        uint16_t hi = u8();
+        return static_cast<uint16_t>(lo | (hi << 8));
+    }
+
+    uint64_t u64()
+    {
+        uint64_t v = 0;
+        for (unsigned i = 0; i < 8; ++i)
+        {
+            v |= static_cast<uint64_t>(u8()) << (i * 8);
+        }
+        return v;
+    }
+
+    double f64()
+    {
+        uint64_t bits = u64();
+        double v;
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    float f32()
+    {
+        uint32_t bits = 0;
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            bits |= static_cast<uint32_t>(u8()) << (i * 8);
+        }
+        float v;
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    bool str(std::string& s, bool& isNull)
+    {
+        uint64_t len = varint();
+        isNull = len == 0;
+        if (isNull)
+        {
+            s.clear();
+            return !failed;
+        }
+        --len;
+        if (failed || len > in.size() - cursor)
+        {
+            failed = true;
+            return false;
+        }
+        s.assign(reinterpret_cast<const char*>(in.data() + cursor),
+                 static_cast<size_t>(len));
+        cursor += static_cast<size_t>(len);
+        return true;
+    }
+};
+}
+
+EventRecorder::EventRecorder() {}
+
+EventRecorder::~EventRecorder() { close(); }
+
+bool EventRecorder::open(const char* path)
+{
+    close();
+    mFile.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!mFile.is_open())
+    {
+        return false;
+    }
+
+    mBuffer.clear();
+    mBuffer.reserve(sFlushSize * 2);
+    mWindows.clear();
+    mLastMouse = MouseMoveData(0, 0, 0, 0, 0, 0);
+    mStart = getMicroseconds();
+    mLastTimestamp = 0;
+
+    Writer w = {mBuffer};
+    mBuffer.insert(mBuffer.end(), sMagic, sMagic + sizeof(sMagic));
+    w.u16(Version);
+    w.u16(0);
+    return true;
+}
+
+void EventRecorder::close()
+{
+    if (!mFile.is_open())
+    {
+        return;
+    }
+    mBuffer.push_back(static_cast<uint8_t>(RecordTag::End));
+    flush();
+    mFile.close();
+}
+
+bool EventRecorder::isOpen() const { return mFile.is_open(); }
+
+uint64_t EventRecorder::now() const { return getMicroseconds() - mStart; }
+
+void EventRecorder::record(const Event& e) { record(e, now()); }
+
+void EventRecorder::record(const Event& e, uint64_t timestampUs)
+{
+    if (!mFile.is_open() ||
+        static_cast<size_t>(e.type) >=
+            static_cast<size_t>(EventType::EventTypeMax))
+    {
+        return;
+    }
+    beginRecord(static_cast<uint8_t>(e.type), timestampUs);
+    Writer w = {mBuffer};
+    w.varint(getWindowId(e.window));
+    writeEvent(e);
+
+    if (mBuffer.size() >= sFlushSize)
+    {
+        flush();
+    }
+}
+
+void EventRecorder::markFrame() { markFrame(now()); }
+
+void EventRecorder::markFrame(uint64_t timestampUs)
+{
+    if (!mFile.is_open())
+    {
+        return;
+    }
+    beginRecord(static_cast<uint8_t>(RecordTag::Frame), timestampUs);
+}
+
+void EventRecorder::beginRecord(uint8_t tag, uint64_t timestampUs)
+{
+    // Timestamps must be monotonic for the delta encoding to work.
+    if (timestampUs < mLastTimestamp)
+    {
+        timestampUs = mLastTimestamp;
+    }
+    Writer w = {mBuffer};
+    w.u8(tag);
+    w.varint(timestampUs - mLastTimestamp);
+    mLastTimestamp = timestampUs;
+}
+
+uint32_t EventRecorder::getWindowId(const Window* window)
+{
+    if (window == nullptr)
+    {
+        return 0;
+    }
+    for (size_t i = 0; i < mWindows.size(); ++i)
+    {
+        if (mWindows[i] == window)
+        {
+            return static_cast<uint32_t>(i + 1);
+        }
+    }
+    mWindows.push_back(window);
+    return static_cast<uint32_t>(mWindows.size());
+}
+
+void EventRecorder::writeEvent(const Event& e)
+{
+    Writer w = {mBuffer};
+    const EventData& d = e.data;
+
+    switch (e.type)
+    {
+    case EventType::Focus:
+        w.u8(d.focus.focused ? 1 : 0);
+        break;
+    case EventType::Resize:
+        w.varint(d.resize.width);
+        w.varint(d.resize.height);
+        w.u8(d.resize.resizing ? 1 : 0);
+        break;
+    case EventType::DPI:
+        w.f32(d.dpi.scale);
+        break;
+    case EventType::Keyboard:
+        w.varint(static_cast<uint64_t>(d.keyboard.key));
+        w.u8(static_cast<uint8_t>(d.keyboard.state));
+        w.u8(packModifiers(d.keyboard.modifiers));
+        break;
+    case EventType::MouseMove:
+    {
+        const MouseMoveData& m = d.mouseMove;
+        w.svarint(static_cast<int64_t>(m.x) - mLastMouse.x);
+        w.svarint(static_cast<int64_t>(m.y) - mLastMouse.y);
+        w.svarint(static_cast<int64_t>(m.screenx) - mLastMouse.screenx);
+        w.svarint(static_cast<int64_t>(m.screeny) - mLastMouse.screeny);
+        w.svarint(m.deltax);
+        w.svarint(m.deltay);
+        mLastMouse = m;
+        break;
+    }
+    case EventType::MouseRaw:
+        w.svarint(d.mouseRaw.deltax);
+        w.svarint(d.mouseRaw.deltay);
+        break;
+    case EventType::MouseWheel:
+        w.f64(d.mouseWheel.delta);
+        w.u8(packModifiers(d.mouseWheel.modifiers));
+        break;
+    case EventType::MouseInput:
+        w.u8(static_cast<uint8_t>(d.mouseInput.button));
+        w.u8(static_cast<uint8_t>(d.mouseInput.state));
+        w.u8(packModifiers(d.mouseInput.modifiers));
+        break;
+    case EventType::Touch:
+    {
+        unsigned count = d.touch.numTouches < sMaxTouches
+                             ? d.touch.numTouches
+                             : static_cast<unsigned>(sMaxTouches);
+        w.varint(count);
+        for (unsigned i = 0; i < count; ++i)
+        {
+            const TouchPoint& t = d.touch.touches[i];
+            w.varint(t.id);
+            w.varint(t.screenX);
+            w.varint(t.screenY);
+            w.varint(t.clientX);
+            w.varint(t.clientY);
+            w.u8(t.isChanged ? 1 : 0);
+        }
+        break;
+    }
+    case EventType::Gamepad:
+    {
+        const GamepadData& g = d.gamepad;
+        unsigned axes =
+            g.numAxes < sMaxAxes ? g.numAxes : static_cast<unsigned>(sMaxAxes);
+        unsigned buttons = g.numButtons < sMaxButtons
+                               ? g.numButtons
+                               : static_cast<unsigned>(sMaxButtons);
+        w.u8(g.connected ? 1 : 0);
+        w.varint(g.index);
+        w.str(g.id);
+        w.str(g.mapping);
+        w.varint(axes);
+        for (unsigned i = 0; i < axes; ++i)
+        {
+            w.f64(g.axis[i]);
+        }
+        w.varint(buttons);
+        for (unsigned i = 0; i < buttons; ++i)
+        {
+            w.f64(g.analogButton[i]);
+        }
+        for (unsigned i = 0; i < buttons; i += 8)
+        {
+            uint8_t bits = 0;
+            for (unsigned b = 0; b < 8 && i + b < buttons; ++b)
+            {
+                bits |= g.digitalButton[i + b] ? (1 << b) : 0;
+            }
+            w.u8(bits);
+        }
+        break;
+    }
+    case EventType::Timer:
+        w.varint(d.timer.id);
+        w.varint(d.timer.expirations);
+        break;
+    case EventType::FdReady:
+        w.varint(d.fdReady.id);
+        w.svarint(d.fdReady.fd);
+        w.u8((d.fdReady.readable ? 1 : 0) | (d.fdReady.writable ? 2 : 0) |
+             (d.fdReady.hangup ? 4 : 0));
+        break;
+    case EventType::User:
+        // The pointer is only meaningful in the recording process.
+        w.varint(d.user.code);
+        w.varint(d.user.payload[0]);
+        w.varint(d.user.payload[1]);
+        break;
+    default:
+        // Close, Create, Paint, DropFile, HoverFile have no payload.
+        break;
+    }
+}
+
+void EventRecorder::flush()
+{
+    if (!mBuffer.empty())
+    {
+        mFile.write(reinterpret_cast<const char*>(mBuffer.data()),
+                    static_cast<std::streamsize>(mBuffer.size()));
+        mBuffer.clear();
+    }
+    mFile.flush();
+}
+
+EventPlayback::EventPlayback() {}
+
+bool EventPlayback::open(const char* path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        mValid = false;
+        mFinished = true;
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)),
+                              std::istreambuf_iterator<char>());
+    mData.swap(data);
+    return readHeader();
+}
+
+bool EventPlayback::open(const uint8_t* data, size_t size)
+{
+    mData.assign(data, data + size);
+    return readHeader();
+}
+
+bool EventPlayback::readHeader()
+{
+    mCursor = 0;
+    mValid = false;
+    mFinished = true;
+
+    if (mData.size() < sizeof(sMagic) + 4 ||
+        memcmp(mData.data(), sMagic, sizeof(sMagic)) != 0)
+    {
+        return false;
+    }
+    mCursor = sizeof(sMagic);
+    Reader r(mData, mCursor);
+    uint16_t version = r.u16();
+    r.u16();
+    if (version == 0 || version > EventRecorder::Version)
+    {
+        return false;
+    }
+
+    mBegin = mCursor;
+    mValid = true;
+    restart();
+    return true;
+}
+
+void EventPlayback::restart()
+{
+    mCursor = mBegin;
+    mFinished = !mValid;
+    mTimestamp = 0;
+    mStarted = false;
+    mFramesAllowed = 0;
+    mLastMouse = MouseMoveData(0, 0, 0, 0, 0, 0);
+}
+
+void EventPlayback::setMode(Mode mode) { mMode = mode; }
+
+EventPlayback::Mode EventPlayback::getMode() const { return mMode; }
+
+void EventPlayback::setWindow(uint32_t id, Window* window)
+{
+    if (id == 0)
+    {
+        return;
+    }
+    if (mWindows.size() < id)
+    {
+        mWindows.resize(id, nullptr);
+    }
+    mWindows[id - 1] = window;
+}
+
+void EventPlayback::setDefaultWindow(Window* window)
+{
+    mDefaultWindow = window;
+}
+
+Window* EventPlayback::getWindow(uint32_t id) const
+{
+    if (id == 0)
+    {
+        return nullptr;
+    }
+    if (id <= mWindows.size() && mWindows[id - 1] != nullptr)
+    {
+        return mWindows[id - 1];
+    }
+    return mDefaultWindow;
+}
+
+void EventPlayback::step(unsigned frames) { mFramesAllowed += frames; }
+
+void EventPlayback::beginUpdate()
+{
+    switch (mMode)
+    {
+    case Mode::RealTime:
+        mNow = getMicroseconds();
+        if (!mStarted)
+        {
+            mStart = mNow;
+            mStarted = true;
+        }
+        break;
+    case Mode::AsFastAsPossible:
+        mFramesAllowed = 1;
+        break;
+    default:
+        break;
+    }
+}
+
+bool EventPlayback::finished() const { return mFinished; }
+
+bool EventPlayback::poll(Event& e)
+{
+    while (!mFinished)
+    {
+        size_t start = mCursor;
+        Reader r(mData, mCursor);
+        uint8_t tag = r.u8();
+        uint64_t timestamp = mTimestamp + r.varint();
+
+        if (r.failed || tag == static_cast<uint8_t>(RecordTag::End))
+        {
+            mFinished = true;
+            return false;
+        }
+
+        if (mMode == Mode::RealTime)
+        {
+            if (timestamp > mNow - mStart)
+            {
+                mCursor = start;
+                return false;
+            }
+        }
+        else if (mFramesAllowed == 0)
+        {
+            mCursor = start;
+            return false;
+        }
+
+        mTimestamp = timestamp;
+
+        if (tag == static_cast<uint8_t>(RecordTag::Frame))
+        {
+            if (mMode != Mode::RealTime && --mFramesAllowed == 0)
+            {
+                return false;
+            }
+            continue;
+        }
+
+        if (!readEvent(tag, e))
+        {
+            mFinished = true;
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+const char* EventPlayback::intern(const std::string& str)
+{
+    // Look up before inserting so repeated strings don't allocate.
+    std::set<std::string>::const_iterator itr = mStrings.find(str);
+    if (itr == mStrings.end())
+    {
+        itr = mStrings.insert(str).first;
+    }
+    return itr->c_str();
+}
+
+bool EventPlayback::readEvent(uint8_t tag, Event& e)
+{
+    if (tag >= static_cast<uint8_t>(EventType::EventTypeMax))
+    {
+        return false;
+    }
+
+    Reader r(mData, mCursor);
+    EventType type = static_cast<EventType>(tag);
+    Window* window = getWindow(static_cast<uint32_t>(r.varint()));
+
+    e.type = type;
+    e.window = window;
+    EventData& d = e.data;
+
+    switch (type)
+    {
+    case EventType::Focus:
+        d.focus = FocusData(r.u8() != 0);
+        break;
+    case EventType::Resize:
+    {
+        unsigned width = static_cast<unsigned>(r.varint());
+        unsigned height = static_cast<unsigned>(r.varint());
+        d.resize = ResizeData(width, height, r.u8() != 0);
+        break;
+    }
+    case EventType::DPI:
+        d.dpi = DpiData(r.f32());
+        break;
+    case EventType::Keyboard:
+    {
+        uint64_t key = r.varint();
+        uint8_t state = r.u8();
+        if (key >= static_cast<uint64_t>(Key::KeysMax) ||
+            state >= ButtonState::ButtonStateMax)
+        {
+            return false;
+        }
+        d.keyboard = KeyboardData(static_cast<Key>(key),
+                                  static_cast<ButtonState>(state),
+                                  unpackModifiers(r.u8()));
+        break;
+    }
+    case EventType::MouseMove:
+    {
+        MouseMoveData m = mLastMouse;
+        m.x = static_cast<unsigned>(m.x + r.svarint());
+        m.y = static_cast<unsigned>(m.y + r.svarint());
+        m.screenx = static_cast<unsigned>(m.screenx + r.svarint());
+        m.screeny = static_cast<unsigned>(m.screeny + r.svarint());
+        m.deltax = static_cast<int>(r.svarint());
+        m.deltay = static_cast<int>(r.svarint());
+        mLastMouse = m;
+        d.mouseMove = m;
+        break;
+    }
+    case EventType::MouseRaw:
+    {
+        int dx = static_cast<int>(r.svarint());
+        d.mouseRaw = MouseRawData(dx, static_cast<int>(r.svarint()));
+        break;
+    }
+    case EventType::MouseWheel:
+    {
+        double delta = r.f64();
+        d.mouseWheel = MouseWheelData(delta, unpackModifiers(r.u8()));
+        break;
+    }
+    case EventType::MouseInput:
+    {
+        uint8_t button = r.u8();
+        uint8_t state = r.u8();
+        if (button >= MouseInput::MouseInputMax ||
+            state >= ButtonState::ButtonStateMax)
+        {
+            return false;
+        }
+        d.mouseInput = MouseInputData(static_cast<MouseInput>(button),
+                                      static_cast<ButtonState>(state),
+                                      unpackModifiers(r.u8()));
+        break;
+    }
+    case EventType::Touch:
+    {
+        TouchData& t = d.touch;
+        uint64_t count = r.varint();
+        if (count > sMaxTouches)
+        {
+            return false;
+        }
+        t.numTouches = static_cast<unsigned>(count);
+        for (unsigned i = 0; i < t.numTouches; ++i)
+        {
+            TouchPoint& p = t.touches[i];
+            p.id = static_cast<unsigned long>(r.varint());
+            p.screenX = static_cast<unsigned>(r.varint());
+            p.screenY = static_cast<unsigned>(r.varint());
+            p.clientX = static_cast<unsigned>(r.varint());
+            p.clientY = static_cast<unsigned>(r.varint());
+            p.isChanged = r.u8() != 0;
+        }
+        break;
+    }
+    case EventType::Gamepad:
+    {
+        GamepadData& g = d.gamepad;
+        std::string& str = mScratch;
+        bool isNull = false;
+
+        g.connected = r.u8() != 0;
+        g.index = static_cast<size_t>(r.varint());
+        r.str(str, isNull);
+        g.id = isNull ? nullptr : intern(str);
+        r.str(str, isNull);
+        g.mapping = isNull ? nullptr : intern(str);
+
+        uint64_t axes = r.varint();
+        if (axes > sMaxAxes)
+        {
+            return false;
+        }
+        g.numAxes = static_cast<unsigned>(axes);
+        for (unsigned i = 0; i < g.numAxes; ++i)
+        {
+            g.axis[i] = r.f64();
+        }
+
+        uint64_t buttons = r.varint();
+        if (buttons > sMaxButtons)
+        {
+            return false;
+        }
+        g.numButtons = static_cast<unsigned>(buttons);
+        for (unsigned i = 0; i < g.numButtons; ++i)
+        {
+            g.analogButton[i] = r.f64();
+        }
+        for (unsigned i = 0; i < g.numButtons; i += 8)
+        {
+            uint8_t bits = r.u8();
+            for (unsigned b = 0; b < 8 && i + b < g.numButtons; ++b)
+            {
+                g.digitalButton[i + b] = (bits & (1 << b)) != 0;
+            }
+        }
+        break;
+    }
+    case EventType::Timer:
+    {
+        unsigned id = static_cast<unsigned>(r.varint());
+        d.timer = TimerData(id, r.varint());
+        break;
+    }
+    case EventType::FdReady:
+    {
+        unsigned id = static_cast<unsigned>(r.varint());
+        int fd = static_cast<int>(r.svarint());
+        uint8_t flags = r.u8();
+        d.fdReady = FdReadyData(id, fd, (flags & 1) != 0, (flags & 2) != 0,
+                                (flags & 4) != 0);
+        break;
+    }
+    case EventType::User:
+    {
+        unsigned code = static_cast<unsigned>(r.varint());
+        unsigned long long payload0 = r.varint();
+        d.user = UserData(code, payload0, r.varint());
+        break;
+    }
+    default:
+        break;
+    }
+
+    return !r.failed;
+}
+}
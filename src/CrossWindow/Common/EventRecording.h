@@ -0,0 +1,173 @@
+#pragma once
+
+#include "Event.h"
+
+#include <fstream>
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * Deterministic input recording and replay.
+ *
+ * A recording is a small versioned binary stream:
+ *
+ * - Header: "XWEV" magic, uint16 version, uint16 flags (little endian).
+ * - Records: a tag byte (the EventType, or a frame/end marker), a varint
+ *   timestamp delta in microseconds, a varint window id, then the payload of
+ *   that event type.
+ *
+ * Integers are LEB128 varints, signed values are zigzag encoded, and mouse
+ * positions are stored as deltas against the previous MouseMove so steady
+ * pointer motion costs a few bytes per event. Touch and Gamepad payloads only
+ * store the points, axes and buttons that are in use.
+ */
+namespace xwin
+{
+enum class RecordTag : uint8_t
+{
+    // Values below EventTypeMax are events of that type.
+    Frame = 0xFE,
+    End = 0xFF
+};
+
+/**
+ * Writes events (and frame boundaries) to a recording file.
+ */
+class EventRecorder
+{
+  public:
+    static const uint16_t Version = 1;
+
+    EventRecorder();
+
+    ~EventRecorder();
+
+    // Start a new recording at the given path, returns false on failure.
+    bool open(const char* path);
+
+    // Finish the recording and close the file.
+    void close();
+
+    bool isOpen() const;
+
+    // Record an event, stamped with the time since the recording started.
+    void record(const Event& e);
+
+    // Record an event with an explicit timestamp in microseconds.
+    void record(const Event& e, uint64_t timestampUs);
+
+    // Mark the end of an EventQueue::update() worth of events.
+    void markFrame();
+
+    void markFrame(uint64_t timestampUs);
+
+  protected:
+    uint64_t now() const;
+
+    void beginRecord(uint8_t tag, uint64_t timestampUs);
+
+    uint32_t getWindowId(const Window* window);
+
+    void writeEvent(const Event& e);
+
+    void flush();
+
+    std::ofstream mFile;
+    std::vector<uint8_t> mBuffer;
+    std::vector<const Window*> mWindows;
+
+    uint64_t mStart = 0;
+    uint64_t mLastTimestamp = 0;
+
+    MouseMoveData mLastMouse = MouseMoveData(0, 0, 0, 0, 0, 0);
+};
+
+/**
+ * Reads a recording back as a stream of events.
+ */
+class EventPlayback
+{
+  public:
+    enum class Mode
+    {
+        // Deliver events when their recorded timestamp has elapsed.
+        RealTime,
+
+        // Deliver one recorded frame per update, ignoring time.
+        AsFastAsPossible,
+
+        // Deliver one recorded frame per call to step().
+        FrameStepped,
+
+        ModeMax
+    };
+
+    EventPlayback();
+
+    // Load a recording, returns false if it's missing or malformed.
+    bool open(const char* path);
+
+    // Load a recording from memory.
+    bool open(const uint8_t* data, size_t size);
+
+    void setMode(Mode mode);
+
+    Mode getMode() const;
+
+    // Recorded windows are numbered in the order they first appear starting at
+    // 1, map them to live windows here. Unmapped ids use the default window.
+    void setWindow(uint32_t id, Window* window);
+
+    void setDefaultWindow(Window* window);
+
+    // Allow the next n recorded frames through in FrameStepped mode.
+    void step(unsigned frames = 1);
+
+    // Called once per EventQueue::update() before polling.
+    void beginUpdate();
+
+    // Get the next event that is due, returns false when none is due yet.
+    bool poll(Event& e);
+
+    // Rewind to the first record.
+    void restart();
+
+    bool finished() const;
+
+  protected:
+    bool readHeader();
+
+    bool readEvent(uint8_t tag, Event& e);
+
+    Window* getWindow(uint32_t id) const;
+
+    const char* intern(const std::string& str);
+
+    std::vector<uint8_t> mData;
+    size_t mCursor = 0;
+    size_t mBegin = 0;
+    bool mFinished = true;
+    bool mValid = false;
+
+    Mode mMode = Mode::RealTime;
+
+    uint64_t mTimestamp = 0;
+    uint64_t mStart = 0;
+    uint64_t mNow = 0;
+    bool mStarted = false;
+
+    unsigned mFramesAllowed = 0;
+
+    std::vector<Window*> mWindows;
+    Window* mDefaultWindow = nullptr;
+
+    std::set<std::string> mStrings;
+
+    // Reused while decoding strings so steady state playback doesn't allocate
+    std::string mScratch;
+
+    MouseMoveData mLastMouse = MouseMoveData(0, 0, 0, 0, 0, 0);
+};
+}
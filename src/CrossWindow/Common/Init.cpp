@@ -6,11 +6,23 @@ namespace xwin
 namespace
 {
 XWinState xWinState;
+
+#if defined(XWIN_XCB)
+XCBCache xcbCache;
+#endif
 }
 
 bool init(MainArgs)
 {
     xWinState = XWinState(MainArgsVars);
+#if defined(XWIN_XCB)
+    // One round trip for every atom and extension windows will need.
+    if (connection != nullptr && !xcbCache.isInitialized())
+    {
+        xcbCache.init(connection);
+    }
+    xWinState.cache = &xcbCache;
+#endif
     return true;
 }
 const xwin::XWinState& getXWinState() { return xWinState; }
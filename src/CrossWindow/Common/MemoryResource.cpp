@@ -0,0 +1,114 @@
+#include "MemoryResource.h"
+
+#include <atomic>
+#include <new>
+
+namespace xwin
+{
+namespace
+{
+class NewDeleteResource : public MemoryResource
+{
+  protected:
+    void* doAllocate(size_t bytes, size_t alignment) override
+    {
+        // Global operator new is aligned for any fundamental type. The
+        // library is C++14, without aligned new, so larger alignments
+        // over-allocate and keep the real block's address just before the
+        // aligned one.
+        if (alignment <= DefaultAlignment)
+        {
+            return ::operator new(bytes);
+        }
+        void* block = ::operator new(bytes + alignment - 1 + sizeof(void*));
+        uintptr_t aligned =
+            (reinterpret_cast<uintptr_t>(block) + sizeof(void*) + alignment -
+             1) &
+            ~(alignment - 1);
+        reinterpret_cast<void**>(aligned)[-1] = block;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    void doDeallocate(void* p, size_t, size_t alignment) override
+    {
+        ::operator delete(alignment <= DefaultAlignment
+                              ? p
+                              : static_cast<void**>(p)[-1]);
+    }
+
+    bool doIsEqual(const MemoryResource& other) const override
+    {
+        return dynamic_cast<const NewDeleteResource*>(&other) != nullptr;
+    }
+};
+
+NewDeleteResource sNewDeleteResource;
+
+std::atomic<MemoryResource*> sDefaultResource(&sNewDeleteResource);
+}
+
+MemoryResource* getDefaultMemoryResource() { return sDefaultResource.load(); }
+
+MemoryResource* setDefaultMemoryResource(MemoryResource* resource)
+{
+    return sDefaultResource.exchange(resource != nullptr ? resource
+                                                         : &sNewDeleteResource);
+}
+
+ArenaResource::ArenaResource(void* buffer, size_t size,
+                             MemoryResource* upstream)
+    : mBuffer(static_cast<uint8_t*>(buffer)), mSize(size), mUpstream(upstream)
+{
+}
+
+ArenaResource::~ArenaResource() { releaseOverflow(); }
+
+void ArenaResource::reset()
+{
+    releaseOverflow();
+    mUsed = 0;
+}
+
+size_t ArenaResource::getUsed() const { return mUsed; }
+
+size_t ArenaResource::getOverflow() const { return mOverflowBytes; }
+
+void* ArenaResource::doAllocate(size_t bytes, size_t alignment)
+{
+    uintptr_t base = reinterpret_cast<uintptr_t>(mBuffer);
+    uintptr_t aligned = (base + mUsed + alignment - 1) & ~(alignment - 1);
+    size_t end = static_cast<size_t>(aligned - base) + bytes;
+    if (mBuffer != nullptr && end <= mSize)
+    {
+        mUsed = end;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // Prefix the upstream block with a header aligned like the request.
+    alignment = alignment > DefaultAlignment ? alignment : DefaultAlignment;
+    size_t header = (sizeof(Overflow) + alignment - 1) & ~(alignment - 1);
+    uint8_t* block =
+        static_cast<uint8_t*>(mUpstream->allocate(header + bytes, alignment));
+    Overflow* overflow = reinterpret_cast<Overflow*>(block);
+    overflow->next = mOverflow;
+    overflow->bytes = header + bytes;
+    overflow->alignment = alignment;
+    mOverflow = overflow;
+    mOverflowBytes += bytes;
+    return block + header;
+}
+
+void ArenaResource::doDeallocate(void*, size_t, size_t) {}
+
+void ArenaResource::releaseOverflow()
+{
+    while (mOverflow != nullptr)
+    {
+        Overflow* next = mOverflow->next;
+        mUpstream->deallocate(mOverflow, mOverflow->bytes,
+                              mOverflow->alignment);
+        mOverflow = next;
+    }
+    mOverflowBytes = 0;
+}
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A C++14 take on std::pmr::memory_resource so applications can route
+ * CrossWindow's internal memory (event queue storage, window lookup tables,
+ * etc.) through their own allocators for budgeting and leak tracking.
+ */
+namespace xwin
+{
+// Alignments must be powers of two, any size is supported.
+class MemoryResource
+{
+  public:
+    static const size_t DefaultAlignment = alignof(max_align_t);
+
+    virtual ~MemoryResource() {}
+
+    void* allocate(size_t bytes, size_t alignment = DefaultAlignment)
+    {
+        return doAllocate(bytes, alignment);
+    }
+
+    void deallocate(void* p, size_t bytes,
+                    size_t alignment = DefaultAlignment)
+    {
+        doDeallocate(p, bytes, alignment);
+    }
+
+    bool isEqual(const MemoryResource& other) const
+    {
+        return doIsEqual(other);
+    }
+
+  protected:
+    virtual void* doAllocate(size_t bytes, size_t alignment) = 0;
+
+    virtual void doDeallocate(void* p, size_t bytes, size_t alignment) = 0;
+
+    virtual bool doIsEqual(const MemoryResource& other) const
+    {
+        return this == &other;
+    }
+};
+
+// The resource used when none is given, global operator new/delete unless
+// replaced.
+MemoryResource* getDefaultMemoryResource();
+
+// Replace the default resource, nullptr restores new/delete. Returns the
+// previous resource. Objects keep the resource they were created with.
+MemoryResource* setDefaultMemoryResource(MemoryResource* resource);
+
+/**
+ * A bump allocator over a caller provided buffer, falling back to an
+ * upstream resource when the buffer is exhausted. Deallocation is a no-op,
+ * memory is only reclaimed by reset(), so reset it once everything allocated
+ * from it is gone (such as at the end of a frame, or when the EventQueue
+ * using it is destroyed).
+ */
+class ArenaResource : public MemoryResource
+{
+  public:
+    ArenaResource(void* buffer, size_t size,
+                  MemoryResource* upstream = getDefaultMemoryResource());
+
+    ~ArenaResource();
+
+    // Release every allocation at once.
+    void reset();
+
+    // Bytes handed out from the buffer since the last reset.
+    size_t getUsed() const;
+
+    // Bytes that didn't fit in the buffer and came from upstream.
+    size_t getOverflow() const;
+
+  protected:
+    void* doAllocate(size_t bytes, size_t alignment) override;
+
+    void doDeallocate(void* p, size_t bytes, size_t alignment) override;
+
+    void releaseOverflow();
+
+    // Overflow allocations are chained so reset() can return them upstream.
+    struct Overflow
+    {
+        Overflow* next;
+        size_t bytes;
+        size_t alignment;
+    };
+
+    uint8_t* mBuffer;
+    size_t mSize;
+    size_t mUsed = 0;
+    size_t mOverflowBytes = 0;
+    Overflow* mOverflow = nullptr;
+    MemoryResource* mUpstream;
+};
+
+/**
+ * A standard library allocator over a MemoryResource, for containers.
+ */
+template <typename T> class Allocator
+{
+  public:
+    typedef T value_type;
+
+    Allocator(MemoryResource* resource = getDefaultMemoryResource())
+        : mResource(resource)
+    {
+    }
+
+    template <typename U>
+    Allocator(const Allocator<U>& other) : mResource(other.getResource())
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(mResource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        mResource->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    MemoryResource* getResource() const { return mResource; }
+
+  protected:
+    MemoryResource* mResource;
+};
+
+template <typename T, typename U>
+bool operator==(const Allocator<T>& a, const Allocator<U>& b)
+{
+    return a.getResource() == b.getResource() ||
+           a.getResource()->isEqual(*b.getResource());
+}
+
+template <typename T, typename U>
+bool operator!=(const Allocator<T>& a, const Allocator<U>& b)
+{
+    return !(a == b);
+}
+}
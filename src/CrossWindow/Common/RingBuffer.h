@@ -0,0 +1,136 @@
+#pragma once
+
+#include "MemoryResource.h"
+
+#include <new>
+#include <stddef.h>
+#include <utility>
+
+namespace xwin
+{
+/**
+ * A FIFO ring buffer with power of two capacity, used in place of
+ * std::queue in event queues. Storage only grows when the buffer is full, so
+ * once a queue has reached its steady state depth pushing and popping never
+ * allocates. Storage comes from the given MemoryResource.
+ */
+template <typename T> class RingBuffer
+{
+  public:
+    RingBuffer(MemoryResource* resource = getDefaultMemoryResource())
+        : mResource(resource)
+    {
+    }
+
+    ~RingBuffer()
+    {
+        clear();
+        release();
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    // Make room for at least capacity elements.
+    void reserve(size_t capacity)
+    {
+        if (capacity > this->capacity())
+        {
+            size_t newCapacity = 16;
+            while (newCapacity < capacity)
+            {
+                newCapacity *= 2;
+            }
+            reallocate(newCapacity);
+        }
+    }
+
+    size_t capacity() const { return mData != nullptr ? mMask + 1 : 0; }
+
+    size_t size() const { return mSize; }
+
+    bool empty() const { return mSize == 0; }
+
+    T& front() { return mData[mHead]; }
+
+    const T& front() const { return mData[mHead]; }
+
+    T& back() { return mData[(mHead + mSize - 1) & mMask]; }
+
+    // The i-th element from the front.
+    T& operator[](size_t i) { return mData[(mHead + i) & mMask]; }
+
+    const T& operator[](size_t i) const { return mData[(mHead + i) & mMask]; }
+
+    void push(const T& value) { emplace(value); }
+
+    template <typename... Args> void emplace(Args&&... args)
+    {
+        if (mSize == capacity())
+        {
+            reallocate(mSize == 0 ? 16 : mSize * 2);
+        }
+        new (&mData[(mHead + mSize) & mMask]) T(std::forward<Args>(args)...);
+        ++mSize;
+    }
+
+    void pop()
+    {
+        mData[mHead].~T();
+        mHead = (mHead + 1) & mMask;
+        --mSize;
+    }
+
+    MemoryResource* getResource() const { return mResource; }
+
+    // Exchange contents, storage and memory resources without allocating.
+    void swap(RingBuffer& other)
+    {
+        std::swap(mResource, other.mResource);
+        std::swap(mData, other.mData);
+        std::swap(mMask, other.mMask);
+        std::swap(mHead, other.mHead);
+        std::swap(mSize, other.mSize);
+    }
+
+    void clear()
+    {
+        while (mSize > 0)
+        {
+            pop();
+        }
+        mHead = 0;
+    }
+
+  protected:
+    void reallocate(size_t newCapacity)
+    {
+        T* data = static_cast<T*>(
+            mResource->allocate(sizeof(T) * newCapacity, alignof(T)));
+        for (size_t i = 0; i < mSize; ++i)
+        {
+            T& value = (*this)[i];
+            new (&data[i]) T(std::move(value));
+            value.~T();
+        }
+        release();
+        mData = data;
+        mMask = newCapacity - 1;
+        mHead = 0;
+    }
+
+    void release()
+    {
+        if (mData != nullptr)
+        {
+            mResource->deallocate(mData, sizeof(T) * capacity(), alignof(T));
+        }
+    }
+
+    MemoryResource* mResource;
+    T* mData = nullptr;
+    size_t mMask = 0;
+    size_t mHead = 0;
+    size_t mSize = 0;
+};
+}
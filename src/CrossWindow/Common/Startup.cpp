@@ -0,0 +1,59 @@
+#include "Startup.h"
+
+#include <chrono>
+
+namespace xwin
+{
+namespace
+{
+const size_t sNumPhases = static_cast<size_t>(StartupPhase::StartupPhaseMax);
+
+uint64_t sPhaseTimes[sNumPhases] = {};
+
+const char* sPhaseNames[sNumPhases] = {
+    "main", "connect", "screen", "init", "create", "map", "expose"};
+
+uint64_t getNanoseconds()
+{
+    uint64_t ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+    // Zero is reserved for phases that haven't been reached.
+    return ns == 0 ? 1 : ns;
+}
+}
+
+void markStartupPhase(StartupPhase phase)
+{
+    size_t i = static_cast<size_t>(phase);
+    if (i < sNumPhases && sPhaseTimes[i] == 0)
+    {
+        sPhaseTimes[i] = getNanoseconds();
+    }
+}
+
+uint64_t getStartupPhaseTime(StartupPhase phase)
+{
+    size_t i = static_cast<size_t>(phase);
+    if (i >= sNumPhases || sPhaseTimes[i] == 0)
+    {
+        return 0;
+    }
+    uint64_t origin = sPhaseTimes[static_cast<size_t>(StartupPhase::Main)];
+    return origin != 0 && sPhaseTimes[i] > origin ? sPhaseTimes[i] - origin
+                                                  : 0;
+}
+
+bool hasReachedStartupPhase(StartupPhase phase)
+{
+    size_t i = static_cast<size_t>(phase);
+    return i < sNumPhases && sPhaseTimes[i] != 0;
+}
+
+const char* getStartupPhaseName(StartupPhase phase)
+{
+    size_t i = static_cast<size_t>(phase);
+    return i < sNumPhases ? sPhaseNames[i] : "";
+}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Time to first window instrumentation.
+ *
+ * Backends mark each phase of startup the first time it's reached, the
+ * timings are nanoseconds since the Main phase (the top of main()).
+ */
+namespace xwin
+{
+enum class StartupPhase : size_t
+{
+    // Entered the platform main function
+    Main = 0,
+
+    // Connected to the display server
+    Connect,
+
+    // Chose the screen to create windows on
+    ScreenSelect,
+
+    // xwin::init completed
+    Init,
+
+    // The first Window::create returned
+    WindowCreate,
+
+    // The first window was mapped by the server
+    FirstMap,
+
+    // The first window received its first expose/paint
+    FirstExpose,
+
+    StartupPhaseMax
+};
+
+// Record the current time for a phase, only the first mark is kept.
+void markStartupPhase(StartupPhase phase);
+
+// Nanoseconds from Main to the phase, or 0 if it hasn't been reached.
+uint64_t getStartupPhaseTime(StartupPhase phase);
+
+bool hasReachedStartupPhase(StartupPhase phase);
+
+const char* getStartupPhaseName(StartupPhase phase);
+}
@@ -3,6 +3,7 @@
 #if defined(XWIN_WIN32)
 #include <Windows.h>
 #elif defined(XWIN_XCB)
+#include "../XCB/XCBCache.h"
 #include <xcb/xcb.h>
 #elif defined(XWIN_XLIB)
 #include <X11/Xlib.h>
@@ -41,6 +42,10 @@ struct XWinState
     const char** argv;
     xcb_connection_t* connection;
     xcb_screen_t* screen;
+
+    // Atoms and extensions, fetched once by init()
+    const XCBCache* cache = nullptr;
+
     XWinState(int argc, const char** argv, xcb_connection_t* connection,
               xcb_screen_t* screen)
         : argc(argc), argv(argv), connection(connection), screen(screen)
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace xwin
+{
+/**
+ * Limits how much work a single EventQueue::update(budget) does, so input
+ * processing has an upper bound per frame. A limit of 0 means no limit.
+ */
+class UpdateBudget
+{
+  public:
+    UpdateBudget(uint64_t maxTimeNs = 0, size_t maxEvents = 0)
+        : mMaxTimeNs(maxTimeNs), mMaxEvents(maxEvents)
+    {
+    }
+
+    static UpdateBudget fromMilliseconds(double ms, size_t maxEvents = 0)
+    {
+        return UpdateBudget(static_cast<uint64_t>(ms * 1000000.0), maxEvents);
+    }
+
+    // Start the clock, called by the backend as update begins.
+    void start()
+    {
+        mSpent = 0;
+        if (mMaxTimeNs != 0)
+        {
+            mDeadline = std::chrono::steady_clock::now() +
+                        std::chrono::nanoseconds(mMaxTimeNs);
+        }
+    }
+
+    // Account for decoded OS events.
+    void spend(size_t count = 1) { mSpent += count; }
+
+    bool remaining() const
+    {
+        if (mMaxEvents != 0 && mSpent >= mMaxEvents)
+        {
+            return false;
+        }
+        return mMaxTimeNs == 0 || std::chrono::steady_clock::now() < mDeadline;
+    }
+
+    // OS events decoded since start().
+    size_t getSpent() const { return mSpent; }
+
+  protected:
+    uint64_t mMaxTimeNs;
+    size_t mMaxEvents;
+    size_t mSpent = 0;
+    std::chrono::steady_clock::time_point mDeadline;
+};
+}
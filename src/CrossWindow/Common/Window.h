@@ -26,4 +26,16 @@ namespace xwin
 {
 typedef std::shared_ptr<Window> WindowPtr;
 typedef std::weak_ptr<Window> WindowWeakPtr;
+
+/**
+ * Create windows[i] from descs[i] for count windows, sending every request
+ * before waiting on any so the whole set costs about as much as one window.
+ * results[i], if given, is set to whether windows[i] was created. With
+ * showTogether the windows are shown at once after all have been created,
+ * rather than each as it's created, on backends that support it (XCB).
+ * Returns the number of windows created.
+ */
+size_t createWindows(Window* const* windows, const WindowDesc* descs,
+                     size_t count, EventQueue& eventQueue,
+                     bool* results = nullptr, bool showTogether = true);
 }
\ No newline at end of file
@@ -0,0 +1,25 @@
+#include "Window.h"
+
+namespace xwin
+{
+#if !defined(XWIN_XCB)
+// Backends without pipelined creation create each window in turn. Each is
+// shown as it's created, showTogether only applies to XCB.
+size_t createWindows(Window* const* windows, const WindowDesc* descs,
+                     size_t count, EventQueue& eventQueue, bool* results,
+                     bool /*showTogether*/)
+{
+    size_t created = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        bool result = windows[i]->create(descs[i], eventQueue);
+        if (results != nullptr)
+        {
+            results[i] = result;
+        }
+        created += result ? 1 : 0;
+    }
+    return created;
+}
+#endif
+}
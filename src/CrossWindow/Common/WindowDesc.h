@@ -55,6 +55,10 @@ struct WindowDesc
     bool frame = true;
     // if this window has a shadow
     bool hasShadow = true;
+    // Whether the display server clears newly exposed areas to a background
+    // before the app draws them. Without it, a live resize shows the last
+    // frame instead of flashing the background (no background pixmap on X11).
+    bool serverBackground = true;
 
     // States
 
@@ -64,6 +68,13 @@ struct WindowDesc
     bool fullscreen = false;
     // Is this window a modal?
     bool modal = false;
+    // Is this a popup (a menu or tooltip), shown without a frame and
+    // bypassing the window manager (override-redirect on X11)?
+    bool popup = false;
+    // Should the window manager wait for each frame during a live resize?
+    // The app then calls Window::frameReady() after presenting every frame
+    // (_NET_WM_SYNC_REQUEST on X11).
+    bool syncResize = false;
 
     // App Data
 
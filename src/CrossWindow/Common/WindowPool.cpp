@@ -0,0 +1,128 @@
+#include "WindowPool.h"
+
+#if defined(XWIN_XCB) || defined(XWIN_NOOP)
+
+#include <algorithm>
+#include <new>
+
+namespace xwin
+{
+WindowPool::WindowPool(EventQueue& eventQueue, size_t capacity,
+                       const WindowDesc& desc, MemoryResource* resource)
+    : mEventQueue(eventQueue), mResource(resource), mDesc(desc),
+      mCapacity(capacity), mReady(Allocator<Window*>(resource)),
+      mWindows(Allocator<Window*>(resource))
+{
+    mDesc.popup = true;
+    mDesc.visible = false;
+    mDesc.centered = false;
+    mDesc.fullscreen = false;
+    mReady.reserve(mCapacity);
+}
+
+WindowPool::~WindowPool()
+{
+    while (!mWindows.empty())
+    {
+        destroyWindow(mWindows.back());
+    }
+}
+
+size_t WindowPool::prewarm(size_t count)
+{
+    while (count > 0 && mReady.size() < mCapacity)
+    {
+        Window* window = createWindow(mDesc);
+        if (window == nullptr)
+        {
+            break;
+        }
+        mReady.push_back(window);
+        --count;
+    }
+    return mCapacity - mReady.size();
+}
+
+Window* WindowPool::acquire(long x, long y, unsigned width, unsigned height)
+{
+    if (mReady.empty())
+    {
+        ++mStats.misses;
+        WindowDesc desc = mDesc;
+        desc.x = x;
+        desc.y = y;
+        desc.width = width;
+        desc.height = height;
+        desc.visible = true;
+        return createWindow(desc);
+    }
+
+    ++mStats.hits;
+    Window* window = mReady.back();
+    mReady.pop_back();
+    window->setPosition(static_cast<unsigned>(x), static_cast<unsigned>(y));
+    window->setSize(width, height);
+    window->setVisible(true);
+    return window;
+}
+
+void WindowPool::release(Window* window)
+{
+    if (window == nullptr ||
+        std::find(mWindows.begin(), mWindows.end(), window) ==
+            mWindows.end() ||
+        std::find(mReady.begin(), mReady.end(), window) != mReady.end())
+    {
+        return;
+    }
+    if (mReady.size() >= mCapacity)
+    {
+        ++mStats.discarded;
+        destroyWindow(window);
+        return;
+    }
+    window->setVisible(false);
+    mReady.push_back(window);
+}
+
+size_t WindowPool::getReadyCount() const { return mReady.size(); }
+
+size_t WindowPool::getCapacity() const { return mCapacity; }
+
+const WindowPool::Stats& WindowPool::getStats() const { return mStats; }
+
+void WindowPool::resetStats() { mStats = Stats(); }
+
+Window* WindowPool::createWindow(const WindowDesc& desc)
+{
+    void* memory = mResource->allocate(sizeof(Window), alignof(Window));
+    Window* window = new (memory) Window(mResource);
+    if (!window->create(desc, mEventQueue))
+    {
+        window->~Window();
+        mResource->deallocate(memory, sizeof(Window), alignof(Window));
+        return nullptr;
+    }
+    ++mStats.created;
+    mWindows.push_back(window);
+    return window;
+}
+
+void WindowPool::destroyWindow(Window* window)
+{
+    std::vector<Window*, Allocator<Window*>>::iterator itr =
+        std::find(mWindows.begin(), mWindows.end(), window);
+    if (itr == mWindows.end())
+    {
+        return;
+    }
+    mWindows.erase(itr);
+    mReady.erase(std::remove(mReady.begin(), mReady.end(), window),
+                 mReady.end());
+
+    window->close();
+    window->~Window();
+    mResource->deallocate(window, sizeof(Window), alignof(Window));
+}
+}
+#endif
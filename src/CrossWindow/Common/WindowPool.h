@@ -0,0 +1,84 @@
+#pragma once
+
+#include "MemoryResource.h"
+#include "Window.h"
+
+#include <stddef.h>
+#include <vector>
+
+namespace xwin
+{
+/**
+ * Hidden popup windows created ahead of time, so menus and tooltips appear
+ * without paying for window creation. Acquiring a ready window only moves,
+ * sizes and shows it, and releasing hides it again for the next popup.
+ * Available on the XCB and headless backends.
+ *
+ * Windows are created from the pool's description with popup set (an
+ * override-redirect window on X11, which the window manager leaves alone)
+ * and hidden. Fill the pool with prewarm() once startup is done, a window or
+ * two per frame, creation never waits on the server.
+ */
+class WindowPool
+{
+  public:
+    struct Stats
+    {
+        // Acquired windows that were ready
+        size_t hits = 0;
+        // Acquired windows that had to be created
+        size_t misses = 0;
+        size_t created = 0;
+        // Released windows destroyed because the pool was full
+        size_t discarded = 0;
+    };
+
+    WindowPool(EventQueue& eventQueue, size_t capacity,
+               const WindowDesc& desc = WindowDesc(),
+               MemoryResource* resource = getDefaultMemoryResource());
+
+    // Destroys every window the pool created, including acquired ones.
+    ~WindowPool();
+
+    WindowPool(const WindowPool&) = delete;
+    WindowPool& operator=(const WindowPool&) = delete;
+
+    // Create up to count windows towards the capacity, returns how many are
+    // still missing.
+    size_t prewarm(size_t count = 1);
+
+    // A shown popup at x, y of the given size, from the ready windows if
+    // there are any.
+    Window* acquire(long x, long y, unsigned width, unsigned height);
+
+    // Hide a window from acquire() and keep it ready, or destroy it if the
+    // pool already has capacity ready windows. Windows the pool didn't
+    // create, or that are already ready, are ignored.
+    void release(Window* window);
+
+    size_t getReadyCount() const;
+
+    size_t getCapacity() const;
+
+    const Stats& getStats() const;
+
+    void resetStats();
+
+  protected:
+    Window* createWindow(const WindowDesc& desc);
+
+    void destroyWindow(Window* window);
+
+    EventQueue& mEventQueue;
+    MemoryResource* mResource;
+    WindowDesc mDesc;
+    size_t mCapacity;
+
+    std::vector<Window*, Allocator<Window*>> mReady;
+
+    // Every window the pool owns, ready or acquired
+    std::vector<Window*, Allocator<Window*>> mWindows;
+
+    Stats mStats;
+};
+}
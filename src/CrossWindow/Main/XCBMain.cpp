@@ -1,10 +1,13 @@
 #include "../Common/Init.h"
+#include "../Common/Startup.h"
 #include "Main.h"
 
 #include <xcb/xcb.h>
 
 int main(int argc, const char** argv)
 {
+    xwin::markStartupPhase(xwin::StartupPhase::Main);
+
     int screenNum = 0;
     xcb_connection_t* connection = xcb_connect(nullptr, &screenNum);
 
@@ -12,6 +15,7 @@ int main(int argc, const char** argv)
     {
         return 1;
     }
+    xwin::markStartupPhase(xwin::StartupPhase::Connect);
 
     /* Get the screen whose number is screenNum */
 
@@ -25,8 +29,10 @@ int main(int argc, const char** argv)
     }
 
     xcb_screen_t* screen = iter.data;
+    xwin::markStartupPhase(xwin::StartupPhase::ScreenSelect);
 
     xwin::init(argc, argv, connection, screen);
+    xwin::markStartupPhase(xwin::StartupPhase::Init);
 
     xmain(argc, argv);
 
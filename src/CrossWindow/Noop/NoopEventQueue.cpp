@@ -2,24 +2,72 @@
 
 namespace xwin
 {
-  EventQueue::EventQueue()
-  {
-  }
-
-  void EventQueue::update()
-  {
-  }
-
-  const Event& EventQueue::front()
-  {
-    return e;
-  }
-
-  void EventQueue::pop()
-  {
-  }
-  bool EventQueue::empty()
-  {
-	  return false;
-  }
-}
\ No newline at end of file
+EventQueue::EventQueue(MemoryResource* resource)
+    : EventQueueBase(resource), mMailbox(resource)
+{
+}
+
+void EventQueue::update() { update(UpdateBudget()); }
+
+size_t EventQueue::update(UpdateBudget budget)
+{
+    budget.start();
+
+    mMailbox.drain(mQueue);
+
+    if (mHasDeferred && !mQueue.blocked())
+    {
+        mQueue.push(mDeferred);
+        mHasDeferred = false;
+        budget.spend();
+    }
+
+    if (mPlayback != nullptr)
+    {
+        mPlayback->beginUpdate();
+        Event e;
+        while (!mQueue.blocked() && budget.remaining() && mPlayback->poll(e))
+        {
+            mQueue.emplace(e);
+            budget.spend();
+        }
+
+        // Out of budget, hold on to the next due event so it can be reported
+        // as pending.
+        if (!mHasDeferred && !mQueue.blocked() && !budget.remaining())
+        {
+            mHasDeferred = mPlayback->poll(mDeferred);
+        }
+    }
+
+    if (mSyntheticInput != nullptr && !mQueue.blocked() && budget.remaining())
+    {
+        mSyntheticInput->generate(*this, budget);
+    }
+
+    if (mQueue.hasWaiters())
+    {
+        mQueue.expireWaiters();
+    }
+    return budget.getSpent();
+}
+
+size_t EventQueue::getPendingCount() const { return mHasDeferred ? 1 : 0; }
+
+void EventQueue::pushEvent(const Event& e) { mQueue.emplace(e); }
+
+void EventQueue::postUserEvent(const UserData& data, Window* window)
+{
+    mMailbox.post(Event(data, window));
+}
+
+void EventQueue::setPlayback(EventPlayback* playback)
+{
+    mPlayback = playback;
+}
+
+void EventQueue::setSyntheticInput(SyntheticInput* input)
+{
+    mSyntheticInput = input;
+}
+}
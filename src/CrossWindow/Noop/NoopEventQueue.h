@@ -1,24 +1,58 @@
 #pragma once
 
 #include "../Common/Event.h"
+#include "../Common/EventLanes.h"
+#include "../Common/EventMailbox.h"
+#include "../Common/EventQueueBase.h"
+#include "../Common/EventRecording.h"
+#include "../Common/UpdateBudget.h"
+#include "NoopSyntheticInput.h"
 
 namespace xwin
 {
-  class EventQueue
-  {
-    public:
-    EventQueue();
+/**
+ * The Noop backend is a headless backend with no OS event source. Events
+ * come from headless windows, are pushed manually, played back from a
+ * recording, or generated synthetically, making it usable for tests, CI and
+ * load testing.
+ */
+class EventQueue : public EventQueueBase
+{
+  public:
+    // Internal storage is allocated from the given memory resource.
+    EventQueue(MemoryResource* resource = getDefaultMemoryResource());
 
     void update();
 
-    const Event& front();
+    // Deliver playback and synthetic events until the budget runs out,
+    // returning how many were delivered.
+    size_t update(UpdateBudget budget);
+
+    // 1 if a budgeted update left a due playback event undelivered, the
+    // headless backend can't see further ahead than that.
+    size_t getPendingCount() const;
+
+    // Inject an event as if the OS had sent it.
+    void pushEvent(const Event& e);
+
+    // Queue a User event from any thread, delivered on the next update().
+    void postUserEvent(const UserData& data, Window* window = nullptr);
+
+    // Feed events from a recording on every update(), nullptr to stop.
+    void setPlayback(EventPlayback* playback);
+
+    // Generate synthetic input on every update(), nullptr to stop.
+    void setSyntheticInput(SyntheticInput* input);
 
-    void pop();
+  protected:
+    EventMailbox mMailbox;
 
-	bool empty();
+    EventPlayback* mPlayback = nullptr;
 
-    protected:
-    Event e = Event(EventType::EventTypeMax, nullptr);
-  };
+    SyntheticInput* mSyntheticInput = nullptr;
 
-}
\ No newline at end of file
+    // A due playback event held back by a budgeted update
+    Event mDeferred;
+    bool mHasDeferred = false;
+};
+}
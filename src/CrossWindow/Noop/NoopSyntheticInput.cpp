@@ -0,0 +1,263 @@
+#include "NoopSyntheticInput.h"
+#include "NoopEventQueue.h"
+#include "NoopWindow.h"
+
+namespace xwin
+{
+SyntheticInput::SyntheticInput(uint64_t seed) { reset(seed); }
+
+void SyntheticInput::reset(uint64_t seed)
+{
+    // xorshift can't leave the zero state, so splitmix the seed first.
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    mState = (z ^ (z >> 31)) | 1;
+
+    mEventCount = 0;
+    mTime = 0.0;
+    mStarted = false;
+    mMouse = UVec2();
+    for (Stream& s : mStreams)
+    {
+        s.next = 1.0 / s.hz;
+        s.sent = 0;
+    }
+}
+
+void SyntheticInput::setWindow(Window* window) { mWindow = window; }
+
+void SyntheticInput::setTimeStep(double seconds) { mTimeStep = seconds; }
+
+void SyntheticInput::addMouseMotion(double hz)
+{
+    Stream s = Stream();
+    s.type = StreamType::MouseMotion;
+    s.hz = hz;
+    s.count = 1;
+    addStream(s);
+}
+
+void SyntheticInput::addKeyStorm(double burstsPerSecond, unsigned keysPerBurst)
+{
+    Stream s = Stream();
+    s.type = StreamType::KeyStorm;
+    s.hz = burstsPerSecond;
+    s.count = keysPerBurst;
+    addStream(s);
+}
+
+void SyntheticInput::addResizeSweep(double hz, UVec2 minSize, UVec2 maxSize,
+                                    double periodSeconds)
+{
+    Stream s = Stream();
+    s.type = StreamType::ResizeSweep;
+    s.hz = hz;
+    s.count = 1;
+    s.period = periodSeconds;
+    // Order each axis's bounds so the sweep can't wrap below the minimum.
+    s.minSize = UVec2(minSize.x < maxSize.x ? minSize.x : maxSize.x,
+                      minSize.y < maxSize.y ? minSize.y : maxSize.y);
+    s.maxSize = UVec2(minSize.x < maxSize.x ? maxSize.x : minSize.x,
+                      minSize.y < maxSize.y ? maxSize.y : minSize.y);
+    addStream(s);
+}
+
+void SyntheticInput::addGamepadNoise(double hz, unsigned numAxes,
+                                     double amplitude)
+{
+    Stream s = Stream();
+    s.type = StreamType::GamepadNoise;
+    s.hz = hz;
+    s.count = numAxes;
+    s.amplitude = amplitude;
+    addStream(s);
+}
+
+void SyntheticInput::addStream(Stream stream)
+{
+    if (stream.hz > 0.0)
+    {
+        stream.next = mTime + 1.0 / stream.hz;
+        mStreams.push_back(stream);
+    }
+}
+
+void SyntheticInput::clear() { mStreams.clear(); }
+
+uint64_t SyntheticInput::getEventCount() const { return mEventCount; }
+
+void SyntheticInput::generate(EventQueue& eventQueue)
+{
+    UpdateBudget budget;
+    generate(eventQueue, budget);
+}
+
+void SyntheticInput::generate(EventQueue& eventQueue, UpdateBudget& budget)
+{
+    double seconds = mTimeStep;
+    if (seconds <= 0.0)
+    {
+        std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now();
+        seconds = mStarted
+                      ? std::chrono::duration<double>(now - mLastGenerate)
+                            .count()
+                      : 0.0;
+        mLastGenerate = now;
+        mStarted = true;
+    }
+    advance(seconds, eventQueue, budget);
+}
+
+void SyntheticInput::advance(double seconds, EventQueue& eventQueue)
+{
+    UpdateBudget budget;
+    advance(seconds, eventQueue, budget);
+}
+
+void SyntheticInput::advance(double seconds, EventQueue& eventQueue,
+                             UpdateBudget& budget)
+{
+    mTime += seconds;
+
+    // Merge the streams by event time, the earliest added stream first on a
+    // tie, so the order between streams doesn't depend on how time is sliced.
+    while (budget.remaining())
+    {
+        Stream* due = nullptr;
+        for (Stream& s : mStreams)
+        {
+            if (s.next <= mTime && (due == nullptr || s.next < due->next))
+            {
+                due = &s;
+            }
+        }
+        if (due == nullptr)
+        {
+            break;
+        }
+        uint64_t count = mEventCount;
+        if (emit(*due, due->next, eventQueue))
+        {
+            due->next += 1.0 / due->hz;
+        }
+        budget.spend(static_cast<size_t>(mEventCount - count));
+    }
+}
+
+bool SyntheticInput::emit(Stream& stream, double time, EventQueue& eventQueue)
+{
+    switch (stream.type)
+    {
+    case StreamType::MouseMotion:
+    {
+        UVec2 size = mWindow != nullptr ? mWindow->getWindowSize()
+                                        : UVec2(1920, 1080);
+        int dx = static_cast<int>(nextRandom() % 17) - 8;
+        int dy = static_cast<int>(nextRandom() % 17) - 8;
+        long x = static_cast<long>(mMouse.x) + dx;
+        long y = static_cast<long>(mMouse.y) + dy;
+        x = x < 0 ? 0 : (x >= static_cast<long>(size.x) ? size.x - 1 : x);
+        y = y < 0 ? 0 : (y >= static_cast<long>(size.y) ? size.y - 1 : y);
+        mMouse = UVec2(static_cast<unsigned>(x), static_cast<unsigned>(y));
+
+        if (mWindow != nullptr)
+        {
+            mWindow->setMousePosition(mMouse.x, mMouse.y);
+            ++mEventCount;
+        }
+        else
+        {
+            post(Event(MouseMoveData(mMouse.x, mMouse.y, mMouse.x, mMouse.y,
+                                     dx, dy)),
+                 eventQueue);
+        }
+        break;
+    }
+    case StreamType::KeyStorm:
+    {
+        if (stream.sent < stream.count)
+        {
+            Key key = static_cast<Key>(
+                nextRandom() % static_cast<uint64_t>(Key::KeysMax));
+            uint64_t bits = nextRandom();
+            ModifierState mods((bits & 1) != 0, (bits & 2) != 0,
+                               (bits & 4) != 0, false);
+            post(Event(KeyboardData(key, ButtonState::Pressed, mods), mWindow),
+                 eventQueue);
+            post(Event(KeyboardData(key, ButtonState::Released, mods), mWindow),
+                 eventQueue);
+            ++stream.sent;
+        }
+        if (stream.sent < stream.count)
+        {
+            return false;
+        }
+        stream.sent = 0;
+        break;
+    }
+    case StreamType::ResizeSweep:
+    {
+        // Triangle wave between the min and max sizes.
+        double phase = stream.period > 0.0 ? time / stream.period : 0.0;
+        phase -= static_cast<double>(static_cast<uint64_t>(phase));
+        double t = phase < 0.5 ? phase * 2.0 : 2.0 - phase * 2.0;
+        unsigned width = stream.minSize.x +
+                         static_cast<unsigned>(
+                             t * (stream.maxSize.x - stream.minSize.x));
+        unsigned height = stream.minSize.y +
+                          static_cast<unsigned>(
+                              t * (stream.maxSize.y - stream.minSize.y));
+        if (mWindow != nullptr)
+        {
+            mWindow->setSize(width, height);
+            ++mEventCount;
+        }
+        else
+        {
+            post(Event(ResizeData(width, height, true)), eventQueue);
+        }
+        break;
+    }
+    case StreamType::GamepadNoise:
+    {
+        GamepadData g = {};
+        g.connected = true;
+        g.index = 0;
+        g.id = "CrossWindow Synthetic Gamepad";
+        g.mapping = "standard";
+        g.numAxes = stream.count < 64 ? stream.count : 64;
+        for (unsigned i = 0; i < g.numAxes; ++i)
+        {
+            g.axis[i] = (nextUnit() * 2.0 - 1.0) * stream.amplitude;
+        }
+        post(Event(g, mWindow), eventQueue);
+        break;
+    }
+    default:
+        break;
+    }
+    return true;
+}
+
+void SyntheticInput::post(const Event& e, EventQueue& eventQueue)
+{
+    eventQueue.pushEvent(e);
+    ++mEventCount;
+}
+
+uint64_t SyntheticInput::nextRandom()
+{
+    // xorshift64*
+    mState ^= mState >> 12;
+    mState ^= mState << 25;
+    mState ^= mState >> 27;
+    return mState * 0x2545F4914F6CDD1Dull;
+}
+
+double SyntheticInput::nextUnit()
+{
+    return static_cast<double>(nextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "../Common/Event.h"
+#include "../Common/UpdateBudget.h"
+#include "../Common/WindowDesc.h"
+
+#include <chrono>
+#include <stdint.h>
+#include <vector>
+
+namespace xwin
+{
+class EventQueue;
+class Window;
+
+/**
+ * A seeded generator of synthetic input for load testing the headless
+ * backend. The same seed, streams and time steps always produce the same
+ * events on every platform.
+ */
+class SyntheticInput
+{
+  public:
+    SyntheticInput(uint64_t seed = 1);
+
+    // Reseed and rewind the generator's clock, streams are kept.
+    void reset(uint64_t seed);
+
+    // Route events through this window, updating its state as they're sent.
+    void setWindow(Window* window);
+
+    // Seconds simulated per generate() call, 0 uses the real elapsed time.
+    void setTimeStep(double seconds);
+
+    // Pointer motion as a random walk across the window.
+    void addMouseMotion(double hz);
+
+    // Bursts of random key press/release pairs.
+    void addKeyStorm(double burstsPerSecond, unsigned keysPerBurst);
+
+    // Resize back and forth between two sizes over the given period, in
+    // whichever order each axis's bounds are given.
+    void addResizeSweep(double hz, UVec2 minSize, UVec2 maxSize,
+                        double periodSeconds);
+
+    // Noisy analog sticks on a connected gamepad.
+    void addGamepadNoise(double hz, unsigned numAxes, double amplitude);
+
+    // Remove every stream.
+    void clear();
+
+    // Generate one time step worth of events.
+    void generate(EventQueue& eventQueue);
+
+    // As generate(), stopping once the budget runs out. Events left due are
+    // generated first by the next call, so the sequence doesn't change. A
+    // key's press and release are always sent together.
+    void generate(EventQueue& eventQueue, UpdateBudget& budget);
+
+    // Generate the events due in the next number of seconds.
+    void advance(double seconds, EventQueue& eventQueue);
+
+    void advance(double seconds, EventQueue& eventQueue, UpdateBudget& budget);
+
+    // Total events generated since the last reset.
+    uint64_t getEventCount() const;
+
+  protected:
+    enum class StreamType
+    {
+        MouseMotion,
+        KeyStorm,
+        ResizeSweep,
+        GamepadNoise,
+        StreamTypeMax
+    };
+
+    struct Stream
+    {
+        StreamType type;
+        double hz;
+        // Time of the stream's next event, in seconds since the reset
+        double next;
+        unsigned count;
+        // Keys of the current burst already sent
+        unsigned sent;
+        double amplitude;
+        double period;
+        UVec2 minSize;
+        UVec2 maxSize;
+    };
+
+    void addStream(Stream stream);
+
+    // Send the stream's next event, or a key storm's next key. Returns true
+    // once everything due at that time has been sent.
+    bool emit(Stream& stream, double time, EventQueue& eventQueue);
+
+    void post(const Event& e, EventQueue& eventQueue);
+
+    uint64_t nextRandom();
+
+    // Uniform value in [0, 1)
+    double nextUnit();
+
+    uint64_t mState = 1;
+    uint64_t mEventCount = 0;
+
+    double mTime = 0.0;
+    double mTimeStep = 1.0 / 60.0;
+
+    std::chrono::steady_clock::time_point mLastGenerate;
+    bool mStarted = false;
+
+    Window* mWindow = nullptr;
+    UVec2 mMouse;
+
+    std::vector<Stream> mStreams;
+};
+}
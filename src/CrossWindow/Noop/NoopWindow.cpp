@@ -2,42 +2,298 @@
 
 namespace xwin
 {
-Window::~Window() { close(); }
+Window::Window(MemoryResource* resource) : mResource(resource) {}
+
+Window::~Window()
+{
+    // Don't post to a queue that may already be gone.
+    mEventQueue = nullptr;
+    close();
+    if (mDispatcher != nullptr)
+    {
+        mDispatcher->removeWindow(this);
+    }
+}
 
 bool Window::create(const WindowDesc& desc, EventQueue& eventQueue)
 {
+    mEventQueue = &eventQueue;
     mDesc = desc;
-    return false;
+
+    if (mDesc.fullscreen)
+    {
+        mDesc.x = 0;
+        mDesc.y = 0;
+        mDesc.width = mDisplaySize.x;
+        mDesc.height = mDisplaySize.y;
+    }
+    else if (mDesc.centered)
+    {
+        mDesc.x = (static_cast<long>(mDisplaySize.x) -
+                   static_cast<long>(mDesc.width)) /
+                  2;
+        mDesc.y = (static_cast<long>(mDisplaySize.y) -
+                   static_cast<long>(mDesc.height)) /
+                  2;
+    }
+
+    mCreated = true;
+    mMinimized = false;
+    mMaximized = false;
+
+    postEvent(Event(EventType::Create, this));
+    if (mDesc.visible)
+    {
+        postEvent(Event(ResizeData(mDesc.width, mDesc.height, false), this));
+        setFocus(true);
+    }
+    return true;
+}
+
+void Window::close()
+{
+    if (!mCreated)
+    {
+        return;
+    }
+    mCreated = false;
+    mFocused = false;
+    mDesc.visible = false;
+    postEvent(Event(EventType::Close, this));
+}
+
+bool Window::trackEventsAsync(
+    const std::function<void(const xwin::Event e)>& fun, uint32_t typeMask)
+{
+    EventDispatcher* dispatcher =
+        mEventQueue != nullptr ? mEventQueue->getDispatcher() : nullptr;
+    if (dispatcher == nullptr)
+    {
+        return false;
+    }
+    if (mDispatcher != nullptr)
+    {
+        mDispatcher->removeWindow(this);
+    }
+    mDispatcher = dispatcher;
+    return dispatcher->addHandler(this, typeMask, fun) !=
+           EventDispatcher::InvalidHandler;
+}
+
+bool Window::isClosed() const { return !mCreated; }
+
+const WindowDesc& Window::getDesc() const { return mDesc; }
+
+void Window::updateDesc(WindowDesc& desc)
+{
+    if (!mCreated)
+    {
+        mDesc = desc;
+        return;
+    }
+
+    // Like XCB, only the properties a window can change after creation are
+    // compared and applied, each through its setter so it posts the same
+    // events as the setter would and unchanged ones post nothing.
+    if (desc.title != mDesc.title)
+    {
+        setTitle(desc.title);
+    }
+    if (desc.name != mDesc.name)
+    {
+        mDesc.name = desc.name;
+    }
+    setBackgroundColor(desc.backgroundColor);
+
+    // Size limits first, so the new size is clamped to them.
+    mDesc.minWidth = desc.minWidth;
+    mDesc.minHeight = desc.minHeight;
+    mDesc.maxWidth = desc.maxWidth;
+    mDesc.maxHeight = desc.maxHeight;
+
+    if (desc.fullscreen != mDesc.fullscreen)
+    {
+        mDesc.fullscreen = desc.fullscreen;
+        if (desc.fullscreen)
+        {
+            mDesc.x = 0;
+            mDesc.y = 0;
+            setSize(mDisplaySize.x, mDisplaySize.y);
+        }
+        else
+        {
+            // Leaving fullscreen goes to the position and size asked for.
+            mDesc.x = desc.x;
+            mDesc.y = desc.y;
+            setSize(desc.width, desc.height);
+        }
+    }
+    else if (!desc.fullscreen)
+    {
+        if (desc.x != mDesc.x || desc.y != mDesc.y)
+        {
+            setPosition(static_cast<unsigned>(desc.x),
+                        static_cast<unsigned>(desc.y));
+        }
+        if (desc.width != mDesc.width || desc.height != mDesc.height)
+        {
+            setSize(desc.width, desc.height);
+        }
+    }
+    if (desc.visible != mDesc.visible)
+    {
+        setVisible(desc.visible);
+    }
+}
+
+const std::string& Window::getTitle() const { return mDesc.title; }
+
+void Window::setTitle(std::string title) { mDesc.title = title; }
+
+UVec2 Window::getPosition() const
+{
+    return UVec2(static_cast<unsigned>(mDesc.x),
+                 static_cast<unsigned>(mDesc.y));
+}
+
+void Window::setPosition(unsigned x, unsigned y)
+{
+    mDesc.x = static_cast<long>(x);
+    mDesc.y = static_cast<long>(y);
+}
+
+void Window::setVisible(bool visible)
+{
+    if (visible == mDesc.visible || !mCreated)
+    {
+        return;
+    }
+    mDesc.visible = visible;
+    if (visible)
+    {
+        postEvent(Event(ResizeData(mDesc.width, mDesc.height, false), this));
+    }
 }
 
-void Window::close() {}
+bool Window::isVisible() const { return mDesc.visible; }
 
+bool Window::frameReady(unsigned, unsigned) { return false; }
 
-const WindowDesc Window::getDesc() { return mDesc; }
+UVec2 Window::getMousePosition() const { return mMousePosition; }
 
-void Window::updateDesc(WindowDesc& desc) {}
+void Window::setMousePosition(unsigned x, unsigned y)
+{
+    int dx = static_cast<int>(x) - static_cast<int>(mMousePosition.x);
+    int dy = static_cast<int>(y) - static_cast<int>(mMousePosition.y);
+    mMousePosition = UVec2(x, y);
+    postEvent(Event(MouseMoveData(x, y, x + static_cast<unsigned>(mDesc.x),
+                                  y + static_cast<unsigned>(mDesc.y), dx, dy),
+                    this));
+}
 
-void Window::setTitle(std::string title) {}
+bool Window::isMouseVisible() const { return mMouseVisible; }
 
-void Window::setPosition(unsigned x, unsigned y) {}
+void Window::showMouse(bool show) { mMouseVisible = show; }
 
-void Window::setMousePosition(unsigned x, unsigned y) {}
+UVec2 Window::getWindowSize() const
+{
+    return UVec2(mDesc.width, mDesc.height);
+}
 
-void Window::showMouse(bool show) {}
+void Window::setSize(unsigned width, unsigned height)
+{
+    width = width < mDesc.minWidth ? mDesc.minWidth : width;
+    width = width > mDesc.maxWidth ? mDesc.maxWidth : width;
+    height = height < mDesc.minHeight ? mDesc.minHeight : height;
+    height = height > mDesc.maxHeight ? mDesc.maxHeight : height;
 
-void Window::setSize(unsigned width, unsigned height) {}
+    if (width == mDesc.width && height == mDesc.height)
+    {
+        return;
+    }
+    mDesc.width = width;
+    mDesc.height = height;
+    postEvent(Event(ResizeData(width, height, false), this));
+}
 
-void Window::setProgress(float progress) {}
+float Window::getProgress() const { return mProgress; }
 
-UVec2 Window::getCurrentDisplaySize()
+void Window::setProgress(float progress) { mProgress = progress; }
+
+float Window::getDpiScale() const { return mDpiScale; }
+
+void Window::setDpiScale(float scale)
 {
-    UVec2 v;
-    return v;
+    if (scale == mDpiScale)
+    {
+        return;
+    }
+    mDpiScale = scale;
+    postEvent(Event(DpiData(scale), this));
 }
 
-UVec2 Window::getCurrentDisplayPosition()
+unsigned Window::getBackgroundColor() { return mDesc.backgroundColor; }
+
+void Window::setBackgroundColor(unsigned color)
 {
-    UVec2 v;
-    return v;
+    mDesc.backgroundColor = color;
+}
+
+void Window::minimize()
+{
+    if (mMinimized)
+    {
+        return;
+    }
+    mMinimized = true;
+    setFocus(false);
+}
+
+void Window::maximize()
+{
+    if (!mMaximized)
+    {
+        mRestoreDesc = mDesc;
+        mMaximized = true;
+        mMinimized = false;
+        mDesc.x = 0;
+        mDesc.y = 0;
+        setSize(mDisplaySize.x, mDisplaySize.y);
+    }
+    else
+    {
+        mMaximized = false;
+        mDesc.x = mRestoreDesc.x;
+        mDesc.y = mRestoreDesc.y;
+        setSize(mRestoreDesc.width, mRestoreDesc.height);
+    }
+}
+
+bool Window::isMinimized() const { return mMinimized; }
+
+bool Window::isMaximized() const { return mMaximized; }
+
+void Window::setFocus(bool focused)
+{
+    if (focused == mFocused)
+    {
+        return;
+    }
+    mFocused = focused;
+    postEvent(Event(FocusData(focused), this));
+}
+
+bool Window::isFocused() const { return mFocused; }
+
+UVec2 Window::getCurrentDisplaySize() { return mDisplaySize; }
+
+UVec2 Window::getCurrentDisplayPosition() { return UVec2(); }
+
+void Window::postEvent(const Event& e)
+{
+    if (mEventQueue != nullptr)
+    {
+        mEventQueue->pushEvent(e);
+    }
+}
 }
-}
\ No newline at end of file
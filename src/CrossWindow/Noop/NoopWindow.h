@@ -4,41 +4,137 @@
 #include "../Common/Init.h"
 #include "../Common/WindowDesc.h"
 
+#include <functional>
+
 namespace xwin
 {
-class Window;
-
+/**
+ * A headless window, it owns no OS resources but keeps the full state of a
+ * window in memory and posts the same events a real backend would when that
+ * state changes.
+ */
 class Window
 {
   public:
+    // Internal storage is allocated from the given memory resource.
+    Window(MemoryResource* resource = getDefaultMemoryResource());
+
     ~Window();
 
+    // Initialize this headless window, posts a Create event.
     bool create(const WindowDesc& desc, EventQueue& eventQueue);
 
+    // Request that this window be closed, posts a Close event.
     void close();
 
-    const WindowDesc getDesc();
+    // Call fun on one of the event queue's dispatcher threads for each of
+    // this window's events whose type is in typeMask, one call at a time.
+    // Returns false if the queue has no dispatcher (see setDispatcher()).
+    bool trackEventsAsync(const std::function<void(const xwin::Event e)>& fun,
+                          uint32_t typeMask = ~0u);
+
+    // The window's current state, by reference so reading it copies nothing.
+    const WindowDesc& getDesc() const;
 
+    // Apply only the fields of desc that differ from the current state,
+    // posting the events their setters would.
     void updateDesc(WindowDesc& desc);
 
+    // Get the title of this window.
+    const std::string& getTitle() const;
+
     void setTitle(std::string title);
 
+    // Get the position of this window in display space.
+    UVec2 getPosition() const;
+
     void setPosition(unsigned x, unsigned y);
 
+    // Get the last mouse position set or received by this window.
+    UVec2 getMousePosition() const;
+
     void setMousePosition(unsigned x, unsigned y);
 
+    bool isMouseVisible() const;
+
     void showMouse(bool show);
 
+    // Get this window's size in pixels.
+    UVec2 getWindowSize() const;
+
+    // Set the size of this window, posts a Resize event.
     void setSize(unsigned width, unsigned height);
 
+    float getProgress() const;
+
     void setProgress(float progress);
 
+    // Get the DPI scaling for the current window
+    float getDpiScale() const;
+
+    // Set the DPI scaling of the headless display, posts a DPI event.
+    void setDpiScale(float scale);
+
+    unsigned getBackgroundColor();
+
+    void setBackgroundColor(unsigned color);
+
+    // Show or hide this window, posts a Resize event when shown.
+    void setVisible(bool visible);
+
+    bool isVisible() const;
+
+    // Nothing waits on frames headless, so this never acknowledges one.
+    bool frameReady(unsigned width, unsigned height);
+
+    // Request that this window be minimized.
+    void minimize();
+
+    // Toggle between maximized and restored, like Win32.
+    void maximize();
+
+    bool isMinimized() const;
+
+    bool isMaximized() const;
+
+    // Set focus to this window, posts a Focus event on change.
+    void setFocus(bool focused);
+
+    bool isFocused() const;
+
+    bool isClosed() const;
+
     UVec2 getCurrentDisplaySize();
 
     // returns the current top left corner this window is located in
     UVec2 getCurrentDisplayPosition();
 
   protected:
+    void postEvent(const Event& e);
+
+    MemoryResource* mResource;
+
+    // Pointer to this window's event queue
+    EventQueue* mEventQueue = nullptr;
+
+    // Where trackEventsAsync() registered this window
+    EventDispatcher* mDispatcher = nullptr;
+
     WindowDesc mDesc;
+
+    // Size and position to restore to after maximizing
+    WindowDesc mRestoreDesc;
+
+    UVec2 mMousePosition;
+    UVec2 mDisplaySize = UVec2(1920, 1080);
+
+    float mProgress = 0.0f;
+    float mDpiScale = 1.0f;
+
+    bool mCreated = false;
+    bool mMouseVisible = true;
+    bool mMinimized = false;
+    bool mMaximized = false;
+    bool mFocused = false;
 };
 }
@@ -4,7 +4,7 @@ namespace xwin
 {
 Window::Window() {}
 
-bool Window::create(WindowDesc& desc, EventQueue& eventQueue)
+bool Window::create(const WindowDesc& desc, EventQueue& eventQueue)
 {
     mDesc = desc;
 
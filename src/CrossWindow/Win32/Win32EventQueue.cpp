@@ -35,13 +35,26 @@ RAWINPUTDEVICE rawInputDevice[1];
 
 namespace xwin
 {
-EventQueue::EventQueue() { initialized = false; }
+EventQueue::EventQueue(MemoryResource* resource)
+    : EventQueueBase(resource), mMailbox(resource),
+      mRawInputBuffer(Allocator<RAWINPUT>(resource))
+{
+    initialized = false;
+    mThreadId = GetCurrentThreadId();
+}
+
+void EventQueue::update() { update(UpdateBudget()); }
 
-void EventQueue::update()
+size_t EventQueue::update(UpdateBudget budget)
 {
     MSG msg = {};
+    budget.start();
 
-    for (;;)
+    mMailbox.drain(mQueue);
+
+    // While blocked or out of budget, messages stay in the thread's message
+    // queue for the next update.
+    while (!mQueue.blocked() && budget.remaining())
     {
         if (processingMode == ProcessingMode::Poll)
         {
@@ -52,11 +65,26 @@ void EventQueue::update()
             GetMessage(&msg, NULL, 0, 0);
 
         if (msg.message == WM_QUIT)
-            return;
+            break;
 
         TranslateMessage(&msg);
         DispatchMessage(&msg);
+        budget.spend();
+
+        // A post may have woken a Dispatch mode wait.
+        mMailbox.drain(mQueue);
     }
+
+    if (mQueue.hasWaiters())
+    {
+        mQueue.expireWaiters();
+    }
+    return budget.getSpent();
+}
+
+size_t EventQueue::getPendingCount() const
+{
+    return HIWORD(GetQueueStatus(QS_ALLINPUT)) != 0 ? 1 : 0;
 }
 
 void EventQueue::setProcessingMode(ProcessingMode mode)
@@ -64,6 +92,14 @@ void EventQueue::setProcessingMode(ProcessingMode mode)
     processingMode = mode;
 }
 
+void EventQueue::postUserEvent(const UserData& data, Window* window)
+{
+    if (mMailbox.post(Event(data, window)))
+    {
+        PostThreadMessage(mThreadId, WM_NULL, 0, 0);
+    }
+}
+
 LRESULT EventQueue::pushEvent(MSG msg, Window* window)
 {
     UINT message = msg.message;
@@ -248,11 +284,12 @@ LRESULT EventQueue::pushEvent(MSG msg, Window* window)
 
         GetRawInputData((HRAWINPUT)msg.lParam, RID_INPUT, NULL, &dwSize,
                         sizeof(RAWINPUTHEADER));
-        LPBYTE lpb = new BYTE[dwSize];
-        if (lpb == NULL)
+        size_t count = (dwSize + sizeof(RAWINPUT) - 1) / sizeof(RAWINPUT);
+        if (mRawInputBuffer.size() < count)
         {
-            // return 0;
+            mRawInputBuffer.resize(count);
         }
+        LPBYTE lpb = reinterpret_cast<LPBYTE>(mRawInputBuffer.data());
 
         if (GetRawInputData((HRAWINPUT)msg.lParam, RID_INPUT, lpb, &dwSize,
                             sizeof(RAWINPUTHEADER)) != dwSize)
@@ -283,7 +320,6 @@ LRESULT EventQueue::pushEvent(MSG msg, Window* window)
                 window);
         }
 
-        delete[] lpb;
         break;
     }
     case WM_MOUSEMOVE:
@@ -824,11 +860,4 @@ LRESULT EventQueue::pushEvent(MSG msg, Window* window)
     }
     return result;
 }
-
-const Event& EventQueue::front() { return mQueue.front(); }
-
-void EventQueue::pop() { mQueue.pop(); }
-
-bool EventQueue::empty() { return mQueue.empty(); }
-size_t EventQueue::size() { return mQueue.size(); }
 }
\ No newline at end of file
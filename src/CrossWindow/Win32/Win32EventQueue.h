@@ -3,27 +3,33 @@
 #include <Windows.h>
 
 #include "../Common/Event.h"
+#include "../Common/EventLanes.h"
+#include "../Common/EventMailbox.h"
+#include "../Common/EventQueueBase.h"
+#include "../Common/MemoryResource.h"
+#include "../Common/UpdateBudget.h"
 
-#include <queue>
+#include <vector>
 
 namespace xwin
 {
 class Window;
 
-class EventQueue
+class EventQueue : public EventQueueBase
 {
   public:
-    EventQueue();
+    // Internal storage is allocated from the given memory resource.
+    EventQueue(MemoryResource* resource = getDefaultMemoryResource());
 
     void update();
 
-    const Event& front();
+    // Dispatch messages until the budget runs out, returning how many were
+    // dispatched. The rest stay in the message queue for the next update.
+    size_t update(UpdateBudget budget);
 
-    void pop();
-
-    bool empty();
-
-	size_t size();
+    // 1 if messages are waiting in the thread's queue, Win32 doesn't report
+    // how many.
+    size_t getPendingCount() const;
 
     enum class ProcessingMode
     {
@@ -33,6 +39,10 @@ class EventQueue
     };
     void setProcessingMode(ProcessingMode mode);
 
+    // Queue a User event from any thread, waking the queue's thread if it's
+    // waiting for messages in update().
+    void postUserEvent(const UserData& data, Window* window = nullptr);
+
     friend class Window;
 
   protected:
@@ -44,7 +54,14 @@ class EventQueue
     unsigned prevMouseX;
     unsigned prevMouseY;
 
-    std::queue<Event> mQueue;
+    EventMailbox mMailbox;
+
+    // The thread that owns the queue, woken with a WM_NULL on post
+    DWORD mThreadId;
+
+    // Reused WM_INPUT buffer, only grows. Held as RAWINPUT so it's aligned
+    // for one, whatever the memory resource.
+    std::vector<RAWINPUT, Allocator<RAWINPUT>> mRawInputBuffer;
 
     /**
      * Virtual Key Codes in Win32 are an unsigned char:
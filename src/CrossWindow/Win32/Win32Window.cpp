@@ -18,7 +18,8 @@ HBRUSH hBrush = CreateSolidBrush(RGB(30, 30, 30));
 
 namespace xwin
 {
-Window::Window(){};
+Window::Window(MemoryResource* resource)
+    : hitRects(Allocator<HitRect>(resource)){};
 
 Window::~Window()
 {
@@ -28,7 +29,7 @@ Window::~Window()
     }
 }
 
-const WindowDesc Window::getDesc() { return mDesc; }
+const WindowDesc& Window::getDesc() { return mDesc; }
 
 bool Window::create(const WindowDesc& desc, EventQueue& eventQueue)
 {
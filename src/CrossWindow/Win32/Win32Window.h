@@ -28,7 +28,8 @@ namespace xwin
 class Window
 {
   public:
-    Window();
+    // Internal storage is allocated from the given memory resource.
+    Window(MemoryResource* resource = getDefaultMemoryResource());
 
     ~Window();
 
@@ -122,14 +123,14 @@ class Window
         UVec2 size;
         HitRectType type;
     };
-    std::vector<HitRect> hitRects;
+    std::vector<HitRect, Allocator<HitRect>> hitRects;
 
     friend class EventQueue;
 
     // Deprecated...
 
     // Get this Window's descriptor object.
-    const WindowDesc getDesc();
+    const WindowDesc& getDesc();
 
     // Update the window descriptor. Useful for batch updates.
     void updateDesc(WindowDesc& desc);
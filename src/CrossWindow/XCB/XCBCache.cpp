@@ -0,0 +1,113 @@
+#include "XCBCache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace xwin
+{
+namespace
+{
+const size_t sAtomCount = (size_t)XCBAtom::XCBAtomMax;
+const size_t sExtensionCount = (size_t)XCBExtension::XCBExtensionMax;
+
+const char* const sAtomNames[sAtomCount] = {"WM_PROTOCOLS",
+                                            "WM_DELETE_WINDOW",
+                                            "WM_NAME",
+                                            "WM_STATE",
+                                            "_NET_WM_STATE",
+                                            "_NET_WM_STATE_FULLSCREEN",
+                                            "_NET_WM_STATE_MAXIMIZED_VERT",
+                                            "_NET_WM_STATE_MAXIMIZED_HORZ",
+                                            "_NET_WM_STATE_HIDDEN",
+                                            "_NET_WM_NAME",
+                                            "_NET_WM_PID",
+                                            "_NET_WM_PING",
+                                            "_NET_WM_SYNC_REQUEST",
+                                            "_NET_WM_SYNC_REQUEST_COUNTER",
+                                            "_NET_WM_WINDOW_TYPE",
+                                            "_NET_WM_WINDOW_TYPE_NORMAL",
+                                            "_NET_WM_WINDOW_TYPE_TOOLTIP",
+                                            "_NET_WM_WINDOW_TYPE_POPUP_MENU",
+                                            "_NET_WM_WINDOW_TYPE_DROPDOWN_MENU",
+                                            "UTF8_STRING"};
+
+const char* const sExtensionNames[sExtensionCount] = {
+    "RANDR", "XInputExtension", "Present", "MIT-SHM", "XKEYBOARD", "SYNC"};
+}
+
+bool XCBCache::init(xcb_connection_t* connection)
+{
+    xcb_intern_atom_cookie_t atomCookies[sAtomCount];
+    xcb_query_extension_cookie_t extensionCookies[sExtensionCount];
+
+    // Send everything before waiting on anything.
+    for (size_t i = 0; i < sAtomCount; ++i)
+    {
+        atomCookies[i] = xcb_intern_atom(connection, 0,
+                                         (uint16_t)strlen(sAtomNames[i]),
+                                         sAtomNames[i]);
+    }
+    for (size_t i = 0; i < sExtensionCount; ++i)
+    {
+        extensionCookies[i] = xcb_query_extension(
+            connection, (uint16_t)strlen(sExtensionNames[i]),
+            sExtensionNames[i]);
+    }
+
+    bool complete = true;
+    for (size_t i = 0; i < sAtomCount; ++i)
+    {
+        xcb_intern_atom_reply_t* reply =
+            xcb_intern_atom_reply(connection, atomCookies[i], nullptr);
+        mAtoms[i] = reply != nullptr ? reply->atom
+                                     : static_cast<xcb_atom_t>(XCB_ATOM_NONE);
+        complete = complete && reply != nullptr;
+        free(reply);
+    }
+    for (size_t i = 0; i < sExtensionCount; ++i)
+    {
+        xcb_query_extension_reply_t* reply =
+            xcb_query_extension_reply(connection, extensionCookies[i], nullptr);
+        XCBExtensionInfo& info = mExtensions[i];
+        if (reply != nullptr)
+        {
+            info.present = reply->present != 0;
+            info.majorOpcode = reply->major_opcode;
+            info.firstEvent = reply->first_event;
+            info.firstError = reply->first_error;
+        }
+        complete = complete && reply != nullptr;
+        free(reply);
+    }
+    mInitialized = true;
+    return complete;
+}
+
+bool XCBCache::isInitialized() const { return mInitialized; }
+
+xcb_atom_t XCBCache::getAtom(XCBAtom atom) const
+{
+    return atom < XCBAtom::XCBAtomMax ? mAtoms[(size_t)atom]
+                                      : static_cast<xcb_atom_t>(XCB_ATOM_NONE);
+}
+
+const XCBExtensionInfo& XCBCache::getExtension(XCBExtension extension) const
+{
+    static const XCBExtensionInfo missing;
+    return extension < XCBExtension::XCBExtensionMax
+               ? mExtensions[(size_t)extension]
+               : missing;
+}
+
+const char* XCBCache::getAtomName(XCBAtom atom)
+{
+    return atom < XCBAtom::XCBAtomMax ? sAtomNames[(size_t)atom] : "";
+}
+
+const char* XCBCache::getExtensionName(XCBExtension extension)
+{
+    return extension < XCBExtension::XCBExtensionMax
+               ? sExtensionNames[(size_t)extension]
+               : "";
+}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <xcb/xcb.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace xwin
+{
+// Atoms interned once at init, see XCBCache.
+enum class XCBAtom : size_t
+{
+    WmProtocols = 0,
+    WmDeleteWindow,
+    WmName,
+    WmState,
+    NetWmState,
+    NetWmStateFullscreen,
+    NetWmStateMaximizedVert,
+    NetWmStateMaximizedHorz,
+    NetWmStateHidden,
+    NetWmName,
+    NetWmPid,
+    NetWmPing,
+    NetWmSyncRequest,
+    NetWmSyncRequestCounter,
+    NetWmWindowType,
+    NetWmWindowTypeNormal,
+    NetWmWindowTypeTooltip,
+    NetWmWindowTypePopupMenu,
+    NetWmWindowTypeDropdownMenu,
+    Utf8String,
+    XCBAtomMax
+};
+
+// Extensions queried once at init, see XCBCache.
+enum class XCBExtension : size_t
+{
+    RandR = 0,
+    XInput,
+    Present,
+    Shm,
+    Xkb,
+    Sync,
+    XCBExtensionMax
+};
+
+struct XCBExtensionInfo
+{
+    bool present = false;
+    uint8_t majorOpcode = 0;
+    uint8_t firstEvent = 0;
+    uint8_t firstError = 0;
+};
+
+/**
+ * Atoms and extension data every XCB window needs, fetched by init() with
+ * every request sent up front and the replies collected after, so startup
+ * pays for one round trip instead of one per atom and extension. The cache is
+ * filled once by xwin::init and read only after, through
+ * getXWinState().cache.
+ */
+class XCBCache
+{
+  public:
+    // Returns false if any reply was missing, those atoms are XCB_ATOM_NONE
+    // and those extensions not present.
+    bool init(xcb_connection_t* connection);
+
+    bool isInitialized() const;
+
+    xcb_atom_t getAtom(XCBAtom atom) const;
+
+    const XCBExtensionInfo& getExtension(XCBExtension extension) const;
+
+    static const char* getAtomName(XCBAtom atom);
+
+    // The name the server knows an extension by.
+    static const char* getExtensionName(XCBExtension extension);
+
+  protected:
+    xcb_atom_t mAtoms[(size_t)XCBAtom::XCBAtomMax] = {};
+    XCBExtensionInfo mExtensions[(size_t)XCBExtension::XCBExtensionMax];
+    bool mInitialized = false;
+};
+}
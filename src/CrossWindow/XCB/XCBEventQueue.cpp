@@ -1,28 +1,496 @@
 #include "XCBEventQueue.h"
 #include "../Common/Init.h"
+#include "../Common/Startup.h"
+#include "XCBWindow.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
 
 namespace xwin
 {
-EventQueue::EventQueue() {}
+namespace
+{
+uint64_t monotonicNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull +
+           static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// epoll ids, sources are numbered from 1
+const uint64_t sConnectionId = 0;
+const uint64_t sWakeId = ~0ull;
+}
+
+EventQueue::EventQueue(MemoryResource* resource)
+    : EventQueueBase(resource), mMailbox(resource),
+      mSources(Allocator<Source>(resource)), mDeferred(resource),
+      mWindows(0, WindowMap::hasher(), WindowMap::key_equal(),
+               WindowMap::allocator_type(resource)),
+      mStatePending(Allocator<Window*>(resource)),
+      mWritePending(Allocator<Window*>(resource))
+{
+    // Created up front so a post from another thread can never race with
+    // the first wait.
+    mWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+EventQueue::~EventQueue()
+{
+    while (!mDeferred.empty())
+    {
+        free(mDeferred.front());
+        mDeferred.pop();
+    }
+    for (const Source& source : mSources)
+    {
+        if (source.timer)
+        {
+            close(source.fd);
+        }
+    }
+    if (mEpoll >= 0)
+    {
+        close(mEpoll);
+    }
+    if (mWakeFd >= 0)
+    {
+        close(mWakeFd);
+    }
+}
+
+bool EventQueue::initEpoll()
+{
+    if (mEpoll < 0)
+    {
+        mEpoll = epoll_create1(EPOLL_CLOEXEC);
+        if (mEpoll < 0)
+        {
+            return false;
+        }
+        if (mWakeFd >= 0)
+        {
+            epoll_event ev = {};
+            ev.events = EPOLLIN;
+            ev.data.u64 = sWakeId;
+            epoll_ctl(mEpoll, EPOLL_CTL_ADD, mWakeFd, &ev);
+        }
+    }
+    xcb_connection_t* connection = getXWinState().connection;
+    if (!mConnectionWatched && connection != nullptr)
+    {
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.u64 = sConnectionId;
+        mConnectionWatched =
+            epoll_ctl(mEpoll, EPOLL_CTL_ADD, xcb_get_file_descriptor(connection),
+                      &ev) == 0;
+    }
+    return true;
+}
+
+EventQueue::Source* EventQueue::findSource(unsigned id)
+{
+    for (Source& source : mSources)
+    {
+        if (source.id == id && !source.removed)
+        {
+            return &source;
+        }
+    }
+    return nullptr;
+}
+
+bool EventQueue::armTimer(Source& source)
+{
+    uint64_t deadline = source.deadline;
+    if (source.slack != 0)
+    {
+        deadline = (deadline + source.slack - 1) / source.slack * source.slack;
+    }
+    itimerspec spec = {};
+    spec.it_value.tv_sec = static_cast<time_t>(deadline / 1000000000ull);
+    spec.it_value.tv_nsec = static_cast<long>(deadline % 1000000000ull);
+    return timerfd_settime(source.fd, TFD_TIMER_ABSTIME, &spec, nullptr) == 0;
+}
+
+unsigned EventQueue::addTimer(uint64_t intervalNs, bool repeat,
+                              uint64_t slackNs)
+{
+    if (intervalNs == 0 || !initEpoll())
+    {
+        return 0;
+    }
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0)
+    {
+        return 0;
+    }
 
-void EventQueue::update()
+    Source source = {};
+    source.id = mNextSourceId++;
+    source.fd = fd;
+    source.timer = true;
+    source.repeat = repeat;
+    source.interval = intervalNs;
+    source.slack = slackNs;
+    source.deadline = monotonicNs() + intervalNs;
+
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.u64 = source.id;
+    if (!armTimer(source) || epoll_ctl(mEpoll, EPOLL_CTL_ADD, fd, &ev) != 0)
+    {
+        close(fd);
+        return 0;
+    }
+    mSources.push_back(source);
+    return source.id;
+}
+
+unsigned EventQueue::addFdSource(int fd, unsigned events, FdCallback callback)
+{
+    if (fd < 0 || !initEpoll())
+    {
+        return 0;
+    }
+
+    Source source = {};
+    source.id = mNextSourceId++;
+    source.fd = fd;
+    source.callback = callback;
+
+    epoll_event ev = {};
+    ev.events = ((events & FdReadable) ? static_cast<uint32_t>(EPOLLIN) : 0u) |
+                ((events & FdWritable) ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    ev.data.u64 = source.id;
+    if (epoll_ctl(mEpoll, EPOLL_CTL_ADD, fd, &ev) != 0)
+    {
+        return 0;
+    }
+    mSources.push_back(source);
+    return source.id;
+}
+
+void EventQueue::removeSource(unsigned id)
+{
+    Source* source = findSource(id);
+    if (source == nullptr)
+    {
+        return;
+    }
+    epoll_ctl(mEpoll, EPOLL_CTL_DEL, source->fd, nullptr);
+    if (source->timer)
+    {
+        close(source->fd);
+    }
+    source->removed = true;
+
+    // Callbacks may remove sources, so erase them once dispatch finishes.
+    if (!mDispatching)
+    {
+        mSources.erase(mSources.begin() + (source - mSources.data()));
+    }
+}
+
+void EventQueue::postUserEvent(const UserData& data, Window* window)
+{
+    if (mMailbox.post(Event(data, window)) && mWakeFd >= 0)
+    {
+        uint64_t one = 1;
+        ssize_t written = write(mWakeFd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+void EventQueue::pollSources(int timeoutMs, UpdateBudget& budget)
+{
+    if (!initEpoll())
+    {
+        return;
+    }
+
+    epoll_event events[16];
+    ++mIoStats.waits;
+    int count = epoll_wait(mEpoll, events, 16, timeoutMs);
+
+    mDispatching = true;
+    for (int i = 0; i < count; ++i)
+    {
+        if (events[i].data.u64 == sWakeId)
+        {
+            uint64_t posts = 0;
+            if (read(mWakeFd, &posts, sizeof(posts)) == sizeof(posts))
+            {
+                mMailbox.drain(mQueue);
+            }
+            continue;
+        }
+
+        unsigned id = static_cast<unsigned>(events[i].data.u64);
+        Source* source =
+            events[i].data.u64 != sConnectionId ? findSource(id) : nullptr;
+        if (source == nullptr)
+        {
+            // The X connection, read by the caller
+            continue;
+        }
+
+        if (source->timer)
+        {
+            uint64_t ticks = 0;
+            if (read(source->fd, &ticks, sizeof(ticks)) != sizeof(ticks))
+            {
+                continue;
+            }
+
+            // Count every period that has elapsed, then re-arm from the
+            // original schedule so slack never accumulates into drift.
+            uint64_t now = monotonicNs();
+            uint64_t expirations = 1;
+            if (source->repeat && now > source->deadline)
+            {
+                expirations += (now - source->deadline) / source->interval;
+            }
+            mQueue.emplace(TimerData(id, expirations));
+            budget.spend();
+
+            if (source->repeat)
+            {
+                source->deadline += expirations * source->interval;
+                armTimer(*source);
+            }
+            else
+            {
+                removeSource(id);
+            }
+        }
+        else
+        {
+            uint32_t flags = events[i].events;
+            FdReadyData data(id, source->fd, (flags & EPOLLIN) != 0,
+                             (flags & EPOLLOUT) != 0,
+                             (flags & (EPOLLHUP | EPOLLERR)) != 0);
+            if (source->callback)
+            {
+                // The callback may add or remove sources, so call it from
+                // outside the source list and put it back afterwards.
+                FdCallback callback = std::move(source->callback);
+                callback(data);
+                if (Source* current = findSource(id))
+                {
+                    current->callback = std::move(callback);
+                }
+            }
+            mQueue.emplace(data);
+            budget.spend();
+        }
+    }
+    mDispatching = false;
+
+    for (size_t i = 0; i < mSources.size();)
+    {
+        if (mSources[i].removed)
+        {
+            mSources.erase(mSources.begin() + i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+void EventQueue::update() { update(UpdateBudget()); }
+
+size_t EventQueue::update(UpdateBudget budget)
 {
     const XWinState& xwinState = getXWinState();
     xcb_connection_t* connection = xwinState.connection;
-    xcb_flush(connection);
-    xcb_wait_for_event(connection);
-    xcb_generic_event_t* e;
-    while (xcb_generic_event_t* e = xcb_poll_for_event(connection))
+    flushPending();
+    ++mIoStats.updates;
+    budget.start();
+
+    // Events left over by the last budgeted update come first.
+    while (!mDeferred.empty() && !mQueue.blocked() && budget.remaining())
     {
+        xcb_generic_event_t* e = mDeferred.front();
+        mDeferred.pop();
         pushEvent(e);
+        free(e);
+        budget.spend();
+    }
+
+    // While blocked, events stay queued in the connection until the consumer
+    // makes room.
+    // Events posted from other threads since the last update.
+    mMailbox.drain(mQueue);
+
+    bool read = false;
+    if (mDeferred.empty() && !mQueue.blocked() && budget.remaining())
+    {
+        bool wait = mProcessingMode == ProcessingMode::Wait;
+        if (!mSources.empty() || (wait && mWakeFd >= 0))
+        {
+            // Sleep in epoll until X, a timer or a source is ready, unless
+            // XCB already has events buffered that epoll can't see.
+            int timeout = wait ? -1 : 0;
+            uint64_t deadline = mQueue.getNextWaiterDeadline();
+            if (wait && deadline != 0)
+            {
+                // Wake for the earliest awaitable timeout, rounding up.
+                uint64_t now = getSteadyTimeNs();
+                timeout = deadline > now ? static_cast<int>(
+                                               (deadline - now + 999999) /
+                                               1000000)
+                                         : 0;
+            }
+            if (xcb_generic_event_t* e =
+                    xcb_poll_for_queued_event(connection))
+            {
+                pushEvent(e);
+                free(e);
+                budget.spend();
+                timeout = 0;
+            }
+            pollSources(timeout, budget);
+        }
+        else if (wait)
+        {
+            ++mIoStats.reads;
+            read = true;
+            if (xcb_generic_event_t* e = xcb_wait_for_event(connection))
+            {
+                pushEvent(e);
+                free(e);
+                budget.spend();
+            }
+        }
     }
+    if (mDeferred.empty())
+    {
+        // Read the socket at most once, then decode what that read brought
+        // in from XCB's buffer.
+        while (!mQueue.blocked() && budget.remaining())
+        {
+            xcb_generic_event_t* e = xcb_poll_for_queued_event(connection);
+            if (e == nullptr && !read)
+            {
+                ++mIoStats.reads;
+                read = true;
+                e = xcb_poll_for_event(connection);
+            }
+            if (e == nullptr)
+            {
+                break;
+            }
+            pushEvent(e);
+            free(e);
+            budget.spend();
+        }
+    }
+
+    // Out of budget, move whatever XCB has already read off the socket aside
+    // undecoded so it can be counted, without reading any more.
+    if (!mQueue.blocked())
+    {
+        while (xcb_generic_event_t* e = xcb_poll_for_queued_event(connection))
+        {
+            mDeferred.push(e);
+        }
+    }
+
+    // Window state replies that arrived with this update's read.
+    for (size_t i = 0; i < mStatePending.size();)
+    {
+        if (mStatePending[i]->collectState())
+        {
+            mStatePending[i] = mStatePending.back();
+            mStatePending.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    if (mQueue.hasWaiters())
+    {
+        mQueue.expireWaiters();
+    }
+    return budget.getSpent();
+}
+
+size_t EventQueue::getPendingCount() const { return mDeferred.size(); }
+
+void EventQueue::setProcessingMode(ProcessingMode mode)
+{
+    mProcessingMode = mode;
 }
 
-const Event& EventQueue::front() { return mQueue.front(); }
+void EventQueue::setBatching(bool batching)
+{
+    mBatching = batching;
+    if (!mBatching)
+    {
+        flushPending();
+    }
+}
+
+bool EventQueue::isBatching() const { return mBatching; }
+
+void EventQueue::commit()
+{
+    // Also sends anything requested directly through XCB.
+    mFlushPending = true;
+    flushPending();
+}
 
-void EventQueue::pop() { mQueue.pop(); }
+const EventQueue::IoStats& EventQueue::getIoStats() const { return mIoStats; }
 
-bool EventQueue::empty() { return mQueue.empty(); }
+void EventQueue::resetIoStats() { mIoStats = IoStats(); }
+
+void EventQueue::requestFlush()
+{
+    mFlushPending = true;
+    if (!mBatching)
+    {
+        flushPending();
+    }
+}
+
+void EventQueue::requestWrite(Window* window, bool queued)
+{
+    if (!queued)
+    {
+        mWritePending.push_back(window);
+    }
+    requestFlush();
+}
+
+void EventQueue::flushPending()
+{
+    for (Window* window : mWritePending)
+    {
+        window->writeChanges();
+    }
+    mWritePending.clear();
+
+    if (!mFlushPending)
+    {
+        return;
+    }
+    mFlushPending = false;
+    ++mIoStats.flushes;
+    xcb_flush(getXWinState().connection);
+}
 
 Key getKey(xcb_keycode_t detail)
 {
@@ -46,24 +514,146 @@ Key getKey(xcb_keycode_t detail)
     return d;
 }
 
+void EventQueue::addWindow(xcb_window_t id, Window* window)
+{
+    mWindows[id] = window;
+}
+
+void EventQueue::removeWindow(xcb_window_t id)
+{
+    WindowMap::iterator itr = mWindows.find(id);
+    if (itr == mWindows.end())
+    {
+        return;
+    }
+    mStatePending.erase(std::remove(mStatePending.begin(),
+                                    mStatePending.end(), itr->second),
+                        mStatePending.end());
+    mWritePending.erase(std::remove(mWritePending.begin(),
+                                    mWritePending.end(), itr->second),
+                        mWritePending.end());
+    mWindows.erase(itr);
+}
+
+Window* EventQueue::findWindow(const xcb_generic_event_t* event)
+{
+    xcb_window_t id = XCB_NONE;
+
+    switch (event->response_type & 0x7f)
+    {
+    case XCB_KEY_PRESS:
+    case XCB_KEY_RELEASE:
+    case XCB_BUTTON_PRESS:
+    case XCB_BUTTON_RELEASE:
+    case XCB_MOTION_NOTIFY:
+        id = ((const xcb_key_press_event_t*)event)->event;
+        break;
+    case XCB_ENTER_NOTIFY:
+    case XCB_LEAVE_NOTIFY:
+        id = ((const xcb_enter_notify_event_t*)event)->event;
+        break;
+    case XCB_EXPOSE:
+        id = ((const xcb_expose_event_t*)event)->window;
+        break;
+    case XCB_MAP_NOTIFY:
+        id = ((const xcb_map_notify_event_t*)event)->window;
+        break;
+    case XCB_UNMAP_NOTIFY:
+        id = ((const xcb_unmap_notify_event_t*)event)->window;
+        break;
+    case XCB_REPARENT_NOTIFY:
+        id = ((const xcb_reparent_notify_event_t*)event)->window;
+        break;
+    case XCB_PROPERTY_NOTIFY:
+        id = ((const xcb_property_notify_event_t*)event)->window;
+        break;
+    case XCB_CONFIGURE_NOTIFY:
+        id = ((const xcb_configure_notify_event_t*)event)->window;
+        break;
+    case XCB_RESIZE_REQUEST:
+        id = ((const xcb_resize_request_event_t*)event)->window;
+        break;
+    case XCB_CLIENT_MESSAGE:
+        id = ((const xcb_client_message_event_t*)event)->window;
+        break;
+    default:
+        return nullptr;
+    }
+
+    WindowMap::const_iterator itr = mWindows.find(id);
+    return itr != mWindows.end() ? itr->second : nullptr;
+}
+
 void EventQueue::pushEvent(const xcb_generic_event_t* event)
 {
-    Window* window = nullptr;
+    Window* window = findWindow(event);
     uint8_t event_code = event->response_type & 0x7f;
 
     Event e = Event(EventType::None, window);
 
     switch (event_code)
     {
+    case XCB_MAP_NOTIFY:
+    {
+        markStartupPhase(StartupPhase::FirstMap);
+        if (window != nullptr)
+        {
+            window->onMap(true);
+        }
+        break;
+    }
+    case XCB_UNMAP_NOTIFY:
+    {
+        if (window != nullptr)
+        {
+            window->onMap(false);
+        }
+        break;
+    }
+    case XCB_REPARENT_NOTIFY:
+    {
+        if (window != nullptr)
+        {
+            window->onReparent((const xcb_reparent_notify_event_t*)event);
+        }
+        break;
+    }
+    case XCB_PROPERTY_NOTIFY:
+    {
+        if (window != nullptr &&
+            window->onProperty((const xcb_property_notify_event_t*)event) &&
+            std::find(mStatePending.begin(), mStatePending.end(), window) ==
+                mStatePending.end())
+        {
+            mStatePending.push_back(window);
+        }
+        break;
+    }
     case XCB_CONFIGURE_NOTIFY:
     {
-        e = Event(EventType::Create, window);
+        xcb_configure_notify_event_t* configure =
+            (xcb_configure_notify_event_t*)event;
+
+        // Moves alone only update the window's cached position.
+        if (window == nullptr || window->onConfigure(configure))
+        {
+            // Resizing while the window manager waits on the next frame.
+            e = Event(ResizeData(configure->width, configure->height,
+                                 window != nullptr && window->isSyncPending()),
+                      window);
+        }
         break;
     }
     case XCB_EXPOSE:
     {
+        markStartupPhase(StartupPhase::FirstExpose);
+        // Exposes describe damaged areas, not sizes. A series of them asks
+        // for one repaint, sent with the last.
         xcb_expose_event_t* expose = (xcb_expose_event_t*)event;
-        e = Event(ResizeData(expose->width, expose->height, true), window);
+        if (expose->count == 0)
+        {
+            e = Event(EventType::Paint, window);
+        }
         break;
     }
     case XCB_RESIZE_REQUEST:
@@ -74,16 +664,29 @@ void EventQueue::pushEvent(const xcb_generic_event_t* event)
     }
     case XCB_ENTER_NOTIFY:
     {
+        if (window != nullptr)
+        {
+            window->onFocus(true);
+        }
         e = Event(FocusData(true), window);
         break;
     }
     case XCB_LEAVE_NOTIFY:
     {
+        if (window != nullptr)
+        {
+            window->onFocus(false);
+        }
         e = Event(FocusData(false), window);
         break;
     }
     case XCB_CLIENT_MESSAGE:
     {
+        if (window != nullptr)
+        {
+            window->onClientMessage(
+                (const xcb_client_message_event_t*)event);
+        }
         // Maximize / Minimize...
         break;
     }
@@ -201,8 +804,9 @@ void EventQueue::pushEvent(const xcb_generic_event_t* event)
         bool lock = key->state & XCB_MOD_MASK_LOCK;
         ModifierState mods = ModifierState(control, lock, shift, false);
 
-        e = Event(KeyboardData(getKey(key->detail), ButtonState::Pressed, mods),
-                  window);
+        e = Event(
+            KeyboardData(getKey(key->detail), ButtonState::Released, mods),
+            window);
 
         break;
     }
@@ -1,34 +1,206 @@
 #pragma once
 
 #include "../Common/Event.h"
+#include "../Common/EventLanes.h"
+#include "../Common/EventMailbox.h"
+#include "../Common/EventQueueBase.h"
+#include "../Common/MemoryResource.h"
+#include "../Common/RingBuffer.h"
+#include "../Common/UpdateBudget.h"
 
 #include <xcb/xcb.h>
 
-#include <queue>
+#include <functional>
+#include <unordered_map>
+#include <vector>
 
 namespace xwin
 {
     class Window;
+    struct WindowDesc;
 
     /**
      * Events - https://xcb.freedesktop.org/tutorial/events/
      */
-    class EventQueue
+    class EventQueue : public EventQueueBase
     {
     public:
-        EventQueue();
+        // Internal storage is allocated from the given memory resource.
+        EventQueue(MemoryResource* resource = getDefaultMemoryResource());
+
+        ~EventQueue();
 
         void update();
 
-        const Event &front();
+        // Decode events until the budget runs out, returning how many were
+        // decoded. Anything left over is decoded first by the next update.
+        size_t update(UpdateBudget budget);
 
-        void pop();
+        // Events received from the server that a budgeted update left
+        // undecoded.
+        size_t getPendingCount() const;
 
-        bool empty();
+        /**
+         * The queue owns an epoll set holding the X connection, timers and
+         * any file descriptors the application adds, so one thread can
+         * sleep until any of them is ready. Timers and ready descriptors are
+         * delivered as Timer and FdReady events, in order with window events.
+         */
 
-    protected:
+        // Add a timer that first fires after intervalNs, and then every
+        // intervalNs if it repeats. With slack the timer may fire up to
+        // slackNs late, aligned so timers with the same slack share a
+        // wakeup. Returns the timer's id, or 0 on failure. One shot timers
+        // remove themselves once delivered.
+        unsigned addTimer(uint64_t intervalNs, bool repeat = true,
+                          uint64_t slackNs = 0);
+
+        enum FdEvents
+        {
+            FdReadable = 1,
+            FdWritable = 2
+        };
+
+        typedef std::function<void(const FdReadyData&)> FdCallback;
+
+        // Watch a descriptor (a socket, eventfd, inotify...), which stays
+        // owned by the caller. While it's ready an FdReady event is queued
+        // every update, after calling the callback if one is given. Returns
+        // the source's id, or 0 on failure.
+        unsigned addFdSource(int fd, unsigned events = FdReadable,
+                             FdCallback callback = FdCallback());
+
+        // Remove a timer or descriptor source, safe to call from callbacks.
+        void removeSource(unsigned id);
+
+        // Queue a User event from any thread, waking the queue's thread if
+        // it's waiting in update().
+        void postUserEvent(const UserData& data, Window* window = nullptr);
+
+        enum class ProcessingMode
+        {
+            // Decode whatever events have arrived and return immediately.
+            Poll,
+            // Block until at least one event, timer or source is ready.
+            Wait,
+            ProcessingModeMax
+        };
+        void setProcessingMode(ProcessingMode mode);
+
+        // While batching, window changes stay in XCB's output buffer until
+        // commit() or the next update() instead of being flushed as they're
+        // made, so a frame's worth of changes costs one write.
+        void setBatching(bool batching);
+
+        bool isBatching() const;
+
+        // Send every batched window change to the server.
+        void commit();
+
+        // Calls into XCB that may each make a syscall.
+        struct IoStats
+        {
+            // Flushes that wrote window changes
+            uint64_t flushes = 0;
+            // Socket reads, at most one per update()
+            uint64_t reads = 0;
+            // epoll_wait calls
+            uint64_t waits = 0;
+            uint64_t updates = 0;
+        };
+
+        const IoStats& getIoStats() const;
+
+        void resetIoStats();
+
+        // Decode an XCB event into the queue, public so synthetic events can
+        // be injected without a server.
         void pushEvent(const xcb_generic_event_t* e);
 
-        std::queue<Event> mQueue;
+        friend class Window;
+
+        // Pipelined creation, see Common/Window.h
+        friend size_t createWindows(Window* const* windows,
+                                    const WindowDesc* descs, size_t count,
+                                    EventQueue& eventQueue, bool* results,
+                                    bool showTogether);
+
+    protected:
+        // Windows register themselves on create so events can be routed to
+        // them by XCB window id.
+        void addWindow(xcb_window_t id, Window* window);
+
+        void removeWindow(xcb_window_t id);
+
+        Window* findWindow(const xcb_generic_event_t* e);
+
+        // Called by windows after sending requests, flushes them unless
+        // batching.
+        void requestFlush();
+
+        // Called by windows with changed properties. Their changes are
+        // written just before the next flush, once per window however many
+        // times they changed. queued is true if the window already is.
+        void requestWrite(Window* window, bool queued);
+
+        // Write changed window properties and flush if windows have sent
+        // requests since the last flush.
+        void flushPending();
+
+        struct Source
+        {
+            unsigned id;
+            int fd;
+            bool timer;
+            bool repeat;
+            bool removed;
+            uint64_t interval;
+            uint64_t slack;
+            // Absolute CLOCK_MONOTONIC time of the next expiry
+            uint64_t deadline;
+            FdCallback callback;
+        };
+
+        // Create the epoll set and add the X connection to it.
+        bool initEpoll();
+
+        Source* findSource(unsigned id);
+
+        bool armTimer(Source& source);
+
+        // Wait up to timeoutMs (-1 forever) for sources and queue their events.
+        void pollSources(int timeoutMs, UpdateBudget& budget);
+
+        // Wakes a waiting update() when events are posted from other threads
+        int mWakeFd = -1;
+        EventMailbox mMailbox;
+
+        int mEpoll = -1;
+        bool mConnectionWatched = false;
+        unsigned mNextSourceId = 1;
+        bool mDispatching = false;
+        std::vector<Source, Allocator<Source>> mSources;
+
+        ProcessingMode mProcessingMode = ProcessingMode::Wait;
+
+        bool mBatching = false;
+        bool mFlushPending = false;
+        IoStats mIoStats;
+
+        // Received but undecoded events, owned until decoded.
+        RingBuffer<xcb_generic_event_t*> mDeferred;
+
+        typedef std::unordered_map<
+            xcb_window_t, Window*, std::hash<xcb_window_t>,
+            std::equal_to<xcb_window_t>,
+            Allocator<std::pair<const xcb_window_t, Window*>>>
+            WindowMap;
+        WindowMap mWindows;
+
+        // Windows waiting on a _NET_WM_STATE reply
+        std::vector<Window*, Allocator<Window*>> mStatePending;
+
+        // Windows with changes to write on the next flush
+        std::vector<Window*, Allocator<Window*>> mWritePending;
     };
 }
\ No newline at end of file
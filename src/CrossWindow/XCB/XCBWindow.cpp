@@ -1,42 +1,748 @@
 #include "XCBWindow.h"
+#include "../Common/Startup.h"
+
+#include <xcb/xcbext.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/uio.h>
+#include <vector>
 
 namespace xwin
 {
-Window::Window() {}
+namespace
+{
+// The few SYNC extension requests windows need, encoded here since the
+// xcb-sync bindings aren't always installed. They're sent with the major
+// opcode from the XCBCache, so they cost no extra round trip.
+enum SyncOpcode : uint8_t
+{
+    SyncInitialize = 0,
+    SyncCreateCounter = 2,
+    SyncSetCounter = 3,
+    SyncDestroyCounter = 6
+};
+
+struct SyncRequest
+{
+    uint8_t majorOpcode;
+    uint8_t minorOpcode;
+    uint16_t length;
+    // Initialize sends the version it wants in place of a counter.
+    uint32_t counter;
+    int32_t valueHi;
+    uint32_t valueLo;
+};
+
+// Send the first size bytes of a SYNC request, returning its sequence.
+unsigned sendSync(xcb_connection_t* connection, uint8_t majorOpcode,
+                  SyncOpcode opcode, SyncRequest& request, size_t size,
+                  bool hasReply)
+{
+    request.minorOpcode = opcode;
+
+    // xcb_send_request needs two spare iovecs in front of the request.
+    iovec parts[3];
+    parts[2].iov_base = &request;
+    parts[2].iov_len = size;
+
+    xcb_protocol_request_t protocol = {};
+    protocol.count = 1;
+    protocol.opcode = majorOpcode;
+    protocol.isvoid = hasReply ? 0 : 1;
+    return xcb_send_request(connection, 0, parts + 2, &protocol);
+}
+
+void sendSyncCounter(xcb_connection_t* connection, uint8_t majorOpcode,
+                     SyncOpcode opcode, uint32_t counter, uint64_t value)
+{
+    SyncRequest request = {};
+    request.counter = counter;
+    request.valueHi = static_cast<int32_t>(value >> 32);
+    request.valueLo = static_cast<uint32_t>(value);
+    sendSync(connection, majorOpcode, opcode, request,
+             opcode == SyncDestroyCounter ? 8 : sizeof(SyncRequest), false);
+}
+}
+
+Window::Window(MemoryResource* resource) : mResource(resource) {}
+
+Window::~Window()
+{
+    // The queue may still route events, or owe a write, to this window.
+    if (mEventQueue != nullptr)
+    {
+        mEventQueue->removeWindow(mXcbWindowId);
+    }
+    if (mDispatcher != nullptr)
+    {
+        mDispatcher->removeWindow(this);
+    }
+}
 
 bool Window::create(const WindowDesc& desc, EventQueue& eventQueue)
+{
+    request(desc, eventQueue, false);
+    show(desc);
+
+    mEventQueue->requestFlush();
+    markStartupPhase(StartupPhase::WindowCreate);
+
+    return true;
+}
+
+size_t createWindows(Window* const* windows, const WindowDesc* descs,
+                     size_t count, EventQueue& eventQueue, bool* results,
+                     bool showTogether)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    std::vector<xcb_void_cookie_t, Allocator<xcb_void_cookie_t>> cookies(
+        count, xcb_void_cookie_t(),
+        Allocator<xcb_void_cookie_t>(eventQueue.getMemoryResource()));
+
+    // Every window's requests go out before any error is checked, so the
+    // checks below wait on a single round trip.
+    for (size_t i = 0; i < count; ++i)
+    {
+        cookies[i] = windows[i]->request(descs[i], eventQueue, true);
+        if (!showTogether)
+        {
+            windows[i]->show(descs[i]);
+        }
+    }
+
+    xcb_connection_t* connection = getXWinState().connection;
+    size_t created = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        xcb_generic_error_t* error = xcb_request_check(connection, cookies[i]);
+        bool result = error == nullptr;
+        free(error);
+        if (!result)
+        {
+            windows[i]->abandon();
+        }
+        if (results != nullptr)
+        {
+            results[i] = result;
+        }
+        created += result ? 1 : 0;
+    }
+
+    if (showTogether)
+    {
+        // Holding the server while mapping keeps other clients, including
+        // the compositor, from seeing a partly shown set.
+        xcb_grab_server(connection);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (windows[i]->mEventQueue != nullptr)
+            {
+                windows[i]->show(descs[i]);
+            }
+        }
+        xcb_ungrab_server(connection);
+    }
+
+    eventQueue.requestFlush();
+    if (created > 0)
+    {
+        markStartupPhase(StartupPhase::WindowCreate);
+    }
+    return created;
+}
+
+xcb_void_cookie_t Window::request(const WindowDesc& desc,
+                                  EventQueue& eventQueue, bool checked)
 {
     const XWinState& xwinState = getXWinState();
     mConnection = xwinState.connection;
     mScreen = xwinState.screen;
 
+    mDesc = desc;
+    mReparented = false;
+    mDirty = 0;
+    mMapped = false;
+    mSizeRequested = false;
+    mFullscreenRequested = false;
+    mSyncCounter = 0;
+    mSyncRequested = false;
     mXcbWindowId = xcb_generate_id(mConnection);
+    mEventQueue = &eventQueue;
+    mEventQueue->addWindow(mXcbWindowId, this);
 
-    uint32_t mask = XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK;
-    uint32_t value_list[2] = {
-        mScreen->black_pixel,
+    // Values follow the order of their XCB_CW_* bits. Without a server side
+    // background, the contents are kept in the top left on resize and the
+    // rest is left alone until the next frame covers it.
+    uint32_t mask = XCB_CW_OVERRIDE_REDIRECT | XCB_CW_EVENT_MASK;
+    uint32_t value_list[4];
+    size_t valueCount = 0;
+    if (desc.serverBackground)
+    {
+        mask |= XCB_CW_BACK_PIXEL;
+        value_list[valueCount++] = mScreen->black_pixel;
+    }
+    else
+    {
+        mask |= XCB_CW_BACK_PIXMAP | XCB_CW_BIT_GRAVITY;
+        value_list[valueCount++] = XCB_BACK_PIXMAP_NONE;
+        value_list[valueCount++] = XCB_GRAVITY_NORTH_WEST;
+    }
+    value_list[valueCount++] = desc.popup ? 1u : 0u;
+    value_list[valueCount++] =
         XCB_EVENT_MASK_EXPOSURE | XCB_EVENT_MASK_BUTTON_PRESS |
-            XCB_EVENT_MASK_BUTTON_RELEASE | XCB_EVENT_MASK_POINTER_MOTION |
-            XCB_EVENT_MASK_ENTER_WINDOW | XCB_EVENT_MASK_LEAVE_WINDOW |
-            XCB_EVENT_MASK_KEY_PRESS | XCB_EVENT_MASK_KEY_RELEASE};
+        XCB_EVENT_MASK_BUTTON_RELEASE | XCB_EVENT_MASK_POINTER_MOTION |
+        XCB_EVENT_MASK_ENTER_WINDOW | XCB_EVENT_MASK_LEAVE_WINDOW |
+        XCB_EVENT_MASK_KEY_PRESS | XCB_EVENT_MASK_KEY_RELEASE |
+        XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_PROPERTY_CHANGE;
+
+    xcb_void_cookie_t cookie =
+        checked
+            ? xcb_create_window_checked(
+                  mConnection, XCB_COPY_FROM_PARENT, mXcbWindowId,
+                  mScreen->root, desc.x, desc.y, desc.width, desc.height, 0,
+                  XCB_WINDOW_CLASS_INPUT_OUTPUT, mScreen->root_visual, mask,
+                  value_list)
+            : xcb_create_window(mConnection, XCB_COPY_FROM_PARENT,
+                                mXcbWindowId, mScreen->root, desc.x, desc.y,
+                                desc.width, desc.height, 0,
+                                XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                                mScreen->root_visual, mask, value_list);
+
+    xcb_change_property(mConnection, XCB_PROP_MODE_REPLACE, mXcbWindowId,
+                        XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8,
+                        static_cast<uint32_t>(desc.title.size()),
+                        desc.title.c_str());
+    if (const XCBCache* cache = xwinState.cache)
+    {
+        xcb_change_property(mConnection, XCB_PROP_MODE_REPLACE, mXcbWindowId,
+                            cache->getAtom(XCBAtom::NetWmName),
+                            cache->getAtom(XCBAtom::Utf8String), 8,
+                            static_cast<uint32_t>(desc.title.size()),
+                            desc.title.c_str());
+    }
+
+    // WM_CLASS is the instance and class names, each null terminated.
+    std::string wmClass = desc.name + '\0' + desc.name + '\0';
+    xcb_change_property(mConnection, XCB_PROP_MODE_REPLACE, mXcbWindowId,
+                        XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 8,
+                        static_cast<uint32_t>(wmClass.size()), wmClass.c_str());
 
-    xcb_create_window(mConnection, XCB_COPY_FROM_PARENT, mXcbWindowId,
-                      mScreen->root, desc.x, desc.y, desc.width, desc.height, 0,
-                      XCB_WINDOW_CLASS_INPUT_OUTPUT, mScreen->root_visual, mask,
-                      value_list);
+    const XCBCache* cache = xwinState.cache;
+    if (desc.syncResize && cache != nullptr &&
+        cache->getExtension(XCBExtension::Sync).present)
+    {
+        uint8_t sync = cache->getExtension(XCBExtension::Sync).majorOpcode;
 
-    xcb_map_window(mConnection, mXcbWindowId);
+        // The reply only confirms the version, it's never waited on.
+        SyncRequest initialize = {};
+        const uint8_t version[4] = {3, 1, 0, 0};
+        memcpy(&initialize.counter, version, sizeof(version));
+        xcb_discard_reply(mConnection,
+                          sendSync(mConnection, sync, SyncInitialize,
+                                   initialize, 8, true));
+
+        mSyncCounter = xcb_generate_id(mConnection);
+        sendSyncCounter(mConnection, sync, SyncCreateCounter, mSyncCounter,
+                        0);
+        xcb_change_property(mConnection, XCB_PROP_MODE_REPLACE, mXcbWindowId,
+                            cache->getAtom(XCBAtom::NetWmSyncRequestCounter),
+                            XCB_ATOM_CARDINAL, 32, 1, &mSyncCounter);
+
+        xcb_atom_t protocols[] = {cache->getAtom(XCBAtom::NetWmSyncRequest)};
+        xcb_change_property(mConnection, XCB_PROP_MODE_REPLACE, mXcbWindowId,
+                            cache->getAtom(XCBAtom::WmProtocols),
+                            XCB_ATOM_ATOM, 32, 1, protocols);
+    }
+    return cookie;
+}
+
+void Window::show(const WindowDesc& desc)
+{
+    if (desc.visible)
+    {
+        xcb_map_window(mConnection, mXcbWindowId);
+        mMapped = true;
+    }
 
     const unsigned coords[] = {static_cast<unsigned>(desc.x),
                                static_cast<unsigned>(desc.y)};
     xcb_configure_window(mConnection, mXcbWindowId,
                          XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y, coords);
+}
+
+void Window::abandon()
+{
+    if (mEventQueue != nullptr)
+    {
+        mEventQueue->removeWindow(mXcbWindowId);
+        mEventQueue = nullptr;
+    }
+    mXcbWindowId = 0;
+}
+
+void Window::close()
+{
+    if (mXcbWindowId == 0)
+    {
+        return;
+    }
+    discardState();
+    mDirty = 0;
+    xcb_destroy_window(mConnection, mXcbWindowId);
+    if (mSyncCounter != 0)
+    {
+        sendSyncCounter(
+            mConnection,
+            getXWinState().cache->getExtension(XCBExtension::Sync).majorOpcode,
+            SyncDestroyCounter, mSyncCounter, 0);
+        mSyncCounter = 0;
+        mSyncRequested = false;
+    }
+    mDesc.visible = false;
+    if (mEventQueue != nullptr)
+    {
+        mEventQueue->removeWindow(mXcbWindowId);
+        mEventQueue->requestFlush();
+        mEventQueue = nullptr;
+    }
+}
+
+bool Window::trackEventsAsync(
+    const std::function<void(const xwin::Event e)>& fun, uint32_t typeMask)
+{
+    EventDispatcher* dispatcher =
+        mEventQueue != nullptr ? mEventQueue->getDispatcher() : nullptr;
+    if (dispatcher == nullptr)
+    {
+        return false;
+    }
+    if (mDispatcher != nullptr)
+    {
+        mDispatcher->removeWindow(this);
+    }
+    mDispatcher = dispatcher;
+    return dispatcher->addHandler(this, typeMask, fun) !=
+           EventDispatcher::InvalidHandler;
+}
+
+void Window::setTitle(std::string title)
+{
+    if (mEventQueue == nullptr || title == mDesc.title)
+    {
+        return;
+    }
+    // Nothing reports the title back, so it's cached as it's set.
+    mDesc.title = std::move(title);
+    markDirty(DirtyTitle);
+}
+
+void Window::updateDesc(WindowDesc& desc)
+{
+    if (mEventQueue == nullptr)
+    {
+        return;
+    }
+
+    // Every changed property is marked before the queue is told, so the
+    // whole update goes out in one flush.
+    unsigned dirty = 0;
+    if (desc.title != mDesc.title)
+    {
+        mDesc.title = desc.title;
+        dirty |= DirtyTitle;
+    }
+    if (desc.name != mDesc.name)
+    {
+        mDesc.name = desc.name;
+        dirty |= DirtyName;
+    }
+    if (desc.x != mDesc.x || desc.y != mDesc.y)
+    {
+        mDesc.x = desc.x;
+        mDesc.y = desc.y;
+        dirty |= DirtyPosition;
+    }
+    if (mSizeRequested || (mDirty & DirtySize) != 0
+            ? desc.width != mPendingWidth || desc.height != mPendingHeight
+            : desc.width != mDesc.width || desc.height != mDesc.height)
+    {
+        mPendingWidth = desc.width;
+        mPendingHeight = desc.height;
+        dirty |= DirtySize;
+    }
+    if (desc.visible != mDesc.visible)
+    {
+        mDesc.visible = desc.visible;
+        dirty |= DirtyVisible;
+    }
+    if (mFullscreenRequested || (mDirty & DirtyFullscreen) != 0
+            ? desc.fullscreen != mPendingFullscreen
+            : desc.fullscreen != mDesc.fullscreen)
+    {
+        mPendingFullscreen = desc.fullscreen;
+        dirty |= DirtyFullscreen;
+    }
+    if (dirty != 0)
+    {
+        markDirty(dirty);
+    }
+}
+
+void Window::setPosition(unsigned x, unsigned y)
+{
+    if (mEventQueue == nullptr ||
+        (mDesc.x == static_cast<long>(x) && mDesc.y == static_cast<long>(y)))
+    {
+        return;
+    }
+    mDesc.x = static_cast<long>(x);
+    mDesc.y = static_cast<long>(y);
+    markDirty(DirtyPosition);
+}
+
+void Window::setSize(unsigned width, unsigned height)
+{
+    if (mEventQueue == nullptr ||
+        (mSizeRequested || (mDirty & DirtySize) != 0
+             ? width == mPendingWidth && height == mPendingHeight
+             : width == mDesc.width && height == mDesc.height))
+    {
+        return;
+    }
+    // The cached size follows the ConfigureNotify, so the resize is still
+    // reported as an event.
+    mPendingWidth = width;
+    mPendingHeight = height;
+    markDirty(DirtySize);
+}
+
+void Window::setVisible(bool visible)
+{
+    if (mEventQueue == nullptr || visible == mDesc.visible)
+    {
+        return;
+    }
+    mDesc.visible = visible;
+    markDirty(DirtyVisible);
+}
+
+void Window::markDirty(unsigned dirty)
+{
+    bool queued = mDirty != 0;
+    mDirty |= dirty;
+    mEventQueue->requestWrite(this, queued);
+}
+
+void Window::writeChanges()
+{
+    unsigned dirty = mDirty;
+    mDirty = 0;
+    const XCBCache* cache = getXWinState().cache;
+
+    if ((dirty & DirtyTitle) != 0)
+    {
+        xcb_change_property(mConnection, XCB_PROP_MODE_REPLACE, mXcbWindowId,
+                            XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8,
+                            static_cast<uint32_t>(mDesc.title.size()),
+                            mDesc.title.c_str());
+        if (cache != nullptr)
+        {
+            xcb_change_property(mConnection, XCB_PROP_MODE_REPLACE,
+                                mXcbWindowId,
+                                cache->getAtom(XCBAtom::NetWmName),
+                                cache->getAtom(XCBAtom::Utf8String), 8,
+                                static_cast<uint32_t>(mDesc.title.size()),
+                                mDesc.title.c_str());
+        }
+    }
+    if ((dirty & DirtyName) != 0)
+    {
+        std::string wmClass = mDesc.name + '\0' + mDesc.name + '\0';
+        xcb_change_property(mConnection, XCB_PROP_MODE_REPLACE, mXcbWindowId,
+                            XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 8,
+                            static_cast<uint32_t>(wmClass.size()),
+                            wmClass.c_str());
+    }
+
+    // A move and a resize share one ConfigureWindow, values follow the
+    // order of their XCB_CONFIG_WINDOW_* bits.
+    uint16_t configMask = 0;
+    uint32_t configValues[4];
+    size_t configCount = 0;
+    if ((dirty & DirtyPosition) != 0)
+    {
+        configMask |= XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y;
+        configValues[configCount++] = static_cast<uint32_t>(mDesc.x);
+        configValues[configCount++] = static_cast<uint32_t>(mDesc.y);
+    }
+    if ((dirty & DirtySize) != 0)
+    {
+        configMask |= XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT;
+        configValues[configCount++] = mPendingWidth;
+        configValues[configCount++] = mPendingHeight;
+        mSizeRequested = true;
+    }
+    if (configMask != 0)
+    {
+        xcb_configure_window(mConnection, mXcbWindowId, configMask,
+                             configValues);
+    }
+
+    if ((dirty & DirtyFullscreen) != 0 && cache != nullptr)
+    {
+        xcb_atom_t fullscreen = cache->getAtom(XCBAtom::NetWmStateFullscreen);
+        mFullscreenRequested = true;
+        if (mMapped)
+        {
+            // The window manager owns _NET_WM_STATE once a window is mapped,
+            // it's asked to change it instead.
+            xcb_client_message_event_t message = {};
+            message.response_type = XCB_CLIENT_MESSAGE;
+            message.format = 32;
+            message.window = mXcbWindowId;
+            message.type = cache->getAtom(XCBAtom::NetWmState);
+            message.data.data32[0] = mPendingFullscreen ? 1 : 0;
+            message.data.data32[1] = fullscreen;
+            message.data.data32[3] = 1;
+            xcb_send_event(mConnection, 0, mScreen->root,
+                           XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT |
+                               XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY,
+                           reinterpret_cast<const char*>(&message));
+        }
+        else
+        {
+            xcb_change_property(mConnection, XCB_PROP_MODE_REPLACE,
+                                mXcbWindowId,
+                                cache->getAtom(XCBAtom::NetWmState),
+                                XCB_ATOM_ATOM, 32, mPendingFullscreen ? 1 : 0,
+                                &fullscreen);
+        }
+    }
+
+    // Visibility goes last so a window being shown is mapped with its new
+    // properties already set. Showing and hiding it again within a frame
+    // sends nothing.
+    if ((dirty & DirtyVisible) != 0 && mDesc.visible != mMapped)
+    {
+        if (mDesc.visible)
+        {
+            xcb_map_window(mConnection, mXcbWindowId);
+        }
+        else
+        {
+            xcb_unmap_window(mConnection, mXcbWindowId);
+        }
+        mMapped = mDesc.visible;
+    }
+}
+
+const WindowDesc& Window::getDesc() const { return mDesc; }
 
-    xcb_flush(mConnection);
+const std::string& Window::getTitle() const { return mDesc.title; }
 
+UVec2 Window::getPosition() const
+{
+    return UVec2(static_cast<unsigned>(mDesc.x),
+                 static_cast<unsigned>(mDesc.y));
+}
+
+UVec2 Window::getWindowSize() const
+{
+    return UVec2(mDesc.width, mDesc.height);
+}
+
+bool Window::isVisible() const { return mDesc.visible; }
+
+bool Window::isMinimized() const { return mMinimized; }
+
+bool Window::isMaximized() const { return mMaximized; }
+
+bool Window::isFullscreen() const { return mDesc.fullscreen; }
+
+bool Window::isFocused() const { return mFocused; }
+
+bool Window::onConfigure(const xcb_configure_notify_event_t* configure)
+{
+    // Synthetic events from the window manager are in root coordinates,
+    // real ones are relative to the parent, the frame once reparented.
+    bool synthetic = (configure->response_type & 0x80) != 0;
+    mSizeRequested = false;
+    if (synthetic || !mReparented)
+    {
+        mDesc.x = configure->x;
+        mDesc.y = configure->y;
+    }
+    if (configure->width == mDesc.width && configure->height == mDesc.height)
+    {
+        // The frame on screen already has this size. If the request was
+        // for a new size that's already been configured (a window manager's
+        // synthetic repeat), frameReady() acknowledges it once drawn.
+        if (mSyncRequested && !mSyncConfigured)
+        {
+            acknowledgeSync();
+        }
+        return false;
+    }
+    mSyncConfigured = mSyncRequested;
+    mDesc.width = configure->width;
+    mDesc.height = configure->height;
     return true;
 }
 
-void Window::close() { xcb_destroy_window(mConnection, mXcbWindowId); }
+void Window::onReparent(const xcb_reparent_notify_event_t* reparent)
+{
+    mReparented = mScreen != nullptr && reparent->parent != mScreen->root;
+}
+
+void Window::onMap(bool mapped)
+{
+    mMapped = mapped;
+    if ((mDirty & DirtyVisible) == 0)
+    {
+        mDesc.visible = mapped;
+    }
+}
+
+void Window::onFocus(bool focused) { mFocused = focused; }
+
+bool Window::onClientMessage(const xcb_client_message_event_t* message)
+{
+    const XCBCache* cache = getXWinState().cache;
+    if (mSyncCounter == 0 || message->format != 32 ||
+        message->type != cache->getAtom(XCBAtom::WmProtocols) ||
+        message->data.data32[0] != cache->getAtom(XCBAtom::NetWmSyncRequest))
+    {
+        return false;
+    }
+    // The ConfigureNotify for this request follows, the counter is set once
+    // a frame of that size is ready.
+    mSyncValue = static_cast<uint64_t>(message->data.data32[2]) |
+                 (static_cast<uint64_t>(message->data.data32[3]) << 32);
+    mSyncRequested = true;
+    mSyncConfigured = false;
+    return true;
+}
+
+bool Window::isSyncPending() const { return mSyncRequested; }
+
+bool Window::frameReady(unsigned width, unsigned height)
+{
+    if (!mSyncRequested || !mSyncConfigured || width != mDesc.width ||
+        height != mDesc.height)
+    {
+        return false;
+    }
+    acknowledgeSync();
+    return true;
+}
+
+void Window::acknowledgeSync()
+{
+    mSyncRequested = false;
+    mSyncConfigured = false;
+    sendSyncCounter(
+        mConnection,
+        getXWinState().cache->getExtension(XCBExtension::Sync).majorOpcode,
+        SyncSetCounter, mSyncCounter, mSyncValue);
+    if (mEventQueue != nullptr)
+    {
+        mEventQueue->requestFlush();
+    }
+}
+
+bool Window::onProperty(const xcb_property_notify_event_t* property)
+{
+    const XCBCache* cache = getXWinState().cache;
+    if (cache == nullptr ||
+        property->atom != cache->getAtom(XCBAtom::NetWmState))
+    {
+        return false;
+    }
+
+    // Ask for the new state now and read it when it arrives, rather than
+    // waiting for the reply here.
+    discardState();
+    mStateCookie =
+        xcb_get_property(mConnection, 0, mXcbWindowId,
+                         cache->getAtom(XCBAtom::NetWmState), XCB_ATOM_ATOM, 0,
+                         32);
+    mStatePending = true;
+    return true;
+}
+
+bool Window::collectState()
+{
+    if (!mStatePending)
+    {
+        return true;
+    }
+    void* reply = nullptr;
+    xcb_generic_error_t* error = nullptr;
+    if (xcb_poll_for_reply(mConnection, mStateCookie.sequence, &reply,
+                           &error) == 0)
+    {
+        return false;
+    }
+    mStatePending = false;
+    mFullscreenRequested = false;
+    free(error);
+    if (reply == nullptr)
+    {
+        return true;
+    }
+
+    const XCBCache* cache = getXWinState().cache;
+    xcb_get_property_reply_t* state =
+        static_cast<xcb_get_property_reply_t*>(reply);
+    const xcb_atom_t* atoms =
+        static_cast<const xcb_atom_t*>(xcb_get_property_value(state));
+    int count = xcb_get_property_value_length(state) /
+                static_cast<int>(sizeof(xcb_atom_t));
+
+    bool vertical = false;
+    bool horizontal = false;
+    mMinimized = false;
+    mDesc.fullscreen = false;
+    for (int i = 0; i < count; ++i)
+    {
+        if (atoms[i] == cache->getAtom(XCBAtom::NetWmStateHidden))
+        {
+            mMinimized = true;
+        }
+        else if (atoms[i] == cache->getAtom(XCBAtom::NetWmStateFullscreen))
+        {
+            mDesc.fullscreen = true;
+        }
+        else if (atoms[i] ==
+                 cache->getAtom(XCBAtom::NetWmStateMaximizedVert))
+        {
+            vertical = true;
+        }
+        else if (atoms[i] ==
+                 cache->getAtom(XCBAtom::NetWmStateMaximizedHorz))
+        {
+            horizontal = true;
+        }
+    }
+    mMaximized = vertical && horizontal;
+    free(reply);
+    return true;
+}
+
+void Window::discardState()
+{
+    if (mStatePending)
+    {
+        xcb_discard_reply(mConnection, mStateCookie.sequence);
+        mStatePending = false;
+    }
+}
+
+xcb_window_t Window::getXcbWindow() const { return mXcbWindowId; }
 
 }
\ No newline at end of file
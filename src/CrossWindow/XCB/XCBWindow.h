@@ -6,6 +6,9 @@
 
 #include <xcb/xcb.h>
 
+#include <functional>
+#include <string>
+
 namespace xwin
 {
 /**
@@ -17,14 +20,174 @@ namespace xwin
 class Window
 {
 public:
-    Window();
+    // Internal storage is allocated from the given memory resource.
+    Window(MemoryResource* resource = getDefaultMemoryResource());
+
+    ~Window();
 
     // Initialize this window with the XCB API.
     bool create(const WindowDesc& desc, EventQueue& eventQueue);
 
     void close();
 
+    // Call fun on one of the event queue's dispatcher threads for each of
+    // this window's events whose type is in typeMask, one call at a time.
+    // Returns false if the queue has no dispatcher (see setDispatcher()).
+    bool trackEventsAsync(const std::function<void(const xwin::Event e)>& fun,
+                          uint32_t typeMask = ~0u);
+
+    // The window's last known state. It's kept up to date from the events
+    // the server sends (ConfigureNotify, MapNotify, PropertyNotify), so none
+    // of these getters ever make a request.
+    const WindowDesc& getDesc() const;
+
+    const std::string& getTitle() const;
+
+    void setTitle(std::string title);
+
+    // Apply only the fields of desc that differ from the cached state: the
+    // title, name, position, size, visibility and fullscreen state. Other
+    // fields only apply on create.
+    void updateDesc(WindowDesc& desc);
+
+    // Get the position of this window in display space.
+    UVec2 getPosition() const;
+
+    // Setters don't send anything themselves. Changes are written when the
+    // event queue flushes, so setting the same property again before then
+    // (a title updated every frame while batching) sends one request.
+    void setPosition(unsigned x, unsigned y);
+
+    // Get this window's size in pixels.
+    UVec2 getWindowSize() const;
+
+    void setSize(unsigned width, unsigned height);
+
+    // Map or unmap this window.
+    void setVisible(bool visible);
+
+    bool isVisible() const;
+
+    // From _NET_WM_STATE, as set by the window manager.
+    bool isMinimized() const;
+
+    bool isMaximized() const;
+
+    bool isFullscreen() const;
+
+    bool isFocused() const;
+
+    // Call after presenting a frame drawn at width x height. If the window
+    // manager is waiting on a frame of that size before resizing further
+    // (see WindowDesc::syncResize), it's told the frame is on screen.
+    // Returns true if that happened, calls with nothing waiting are free.
+    bool frameReady(unsigned width, unsigned height);
+
+    // Get this window's XCB window id.
+    xcb_window_t getXcbWindow() const;
+
   protected:
+    friend class EventQueue;
+
+    friend size_t createWindows(Window* const* windows, const WindowDesc* descs,
+                                size_t count, EventQueue& eventQueue,
+                                bool* results, bool showTogether);
+
+    // Send the requests that create this window and set its properties,
+    // without flushing or mapping it.
+    xcb_void_cookie_t request(const WindowDesc& desc, EventQueue& eventQueue,
+                              bool checked);
+
+    // Map the window if desc asks for it visible, then move it into place.
+    void show(const WindowDesc& desc);
+
+    // Forget a window the server failed to create.
+    void abandon();
+
+    // Update the cached state from server events, returning true if the
+    // size changed.
+    bool onConfigure(const xcb_configure_notify_event_t* configure);
+
+    void onReparent(const xcb_reparent_notify_event_t* reparent);
+
+    void onMap(bool mapped);
+
+    void onFocus(bool focused);
+
+    // Handle a _NET_WM_SYNC_REQUEST, returning false for other messages.
+    bool onClientMessage(const xcb_client_message_event_t* message);
+
+    // Whether the window manager is waiting on a frame.
+    bool isSyncPending() const;
+
+    // Set the sync counter to the value the window manager asked for.
+    void acknowledgeSync();
+
+    // Returns true if a _NET_WM_STATE reply is now pending.
+    bool onProperty(const xcb_property_notify_event_t* property);
+
+    // Read a pending _NET_WM_STATE reply if it has arrived, without waiting.
+    // Returns true once nothing is pending.
+    bool collectState();
+
+    void discardState();
+
+    enum Dirty : unsigned
+    {
+        DirtyTitle = 1 << 0,
+        DirtyName = 1 << 1,
+        DirtyPosition = 1 << 2,
+        DirtySize = 1 << 3,
+        DirtyVisible = 1 << 4,
+        DirtyFullscreen = 1 << 5
+    };
+
+    // Mark properties as changed and have the event queue write them.
+    void markDirty(unsigned dirty);
+
+    // Send the requests for every changed property, called by the event
+    // queue just before it flushes.
+    void writeChanges();
+
+    MemoryResource* mResource;
+
+    // Pointer to this window's event queue
+    EventQueue* mEventQueue = nullptr;
+
+    // Where trackEventsAsync() registered this window
+    EventDispatcher* mDispatcher = nullptr;
+
+    WindowDesc mDesc;
+
+    // Whether the window manager has put the window in a frame, real
+    // ConfigureNotify coordinates are then relative to the frame.
+    bool mReparented = false;
+    bool mMinimized = false;
+    bool mMaximized = false;
+    bool mFocused = false;
+
+    xcb_get_property_cookie_t mStateCookie = {};
+    bool mStatePending = false;
+
+    // Properties changed since the last flush, and the requested values that
+    // aren't cached until the server reports them. Until it does, requests
+    // are compared with these instead so they aren't sent twice.
+    unsigned mDirty = 0;
+    unsigned mPendingWidth = 0;
+    unsigned mPendingHeight = 0;
+    bool mPendingFullscreen = false;
+    bool mSizeRequested = false;
+    bool mFullscreenRequested = false;
+    // Whether the server has the window mapped, as of the last flush.
+    bool mMapped = false;
+
+    // The XSync counter the window manager watches with syncResize, the
+    // value it asked for last and whether its ConfigureNotify has arrived.
+    uint32_t mSyncCounter = 0;
+    uint64_t mSyncValue = 0;
+    bool mSyncRequested = false;
+    bool mSyncConfigured = false;
+
     xcb_connection_t* mConnection = nullptr;
     xcb_screen_t* mScreen = nullptr;
     unsigned mXcbWindowId = 0;
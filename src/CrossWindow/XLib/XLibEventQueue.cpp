@@ -20,14 +20,13 @@ void EventQueue::pushEvent(const XEvent* event, Window* window)
     {
     case ConfigureNotify:
     {
-        WindowDesc desc = window->getDesc();
-        if ((desc.width != event->xconfigure.width) ||
-            (desc.height != event->xconfigure.height))
+        WindowDesc& desc = window->mDesc;
+        unsigned width = static_cast<unsigned>(event->xconfigure.width);
+        unsigned height = static_cast<unsigned>(event->xconfigure.height);
+        if (desc.width != width || desc.height != height)
         {
-            unsigned width, height;
-            width = static_cast<unsigned>(event->xconfigure.width);
-            height = static_cast<unsigned>(event->xconfigure.height);
-
+            desc.width = width;
+            desc.height = height;
             mQueue.emplace(ResizeData(width, height, true), window);
         }
         break;
@@ -4,6 +4,7 @@ namespace xwin
 {
 bool Window::create(const WindowDesc& desc, EventQueue& eventQueue)
 {
+    mDesc = desc;
     XInitThreads();
     display = XOpenDisplay(NULL);
     int screen = DefaultScreen(display);
@@ -32,4 +33,11 @@ bool Window::create(const WindowDesc& desc, EventQueue& eventQueue)
 }
 
 bool Window::destroy() { XDestroyWindow(display, window); }
+
+const WindowDesc& Window::getDesc() const { return mDesc; }
+
+UVec2 Window::getWindowSize() const
+{
+    return UVec2(mDesc.width, mDesc.height);
+}
 }
\ No newline at end of file
@@ -19,8 +19,18 @@ class Window
 
     bool destroy();
 
+    // The window's last known state, kept up to date from ConfigureNotify
+    // so reading it never goes to the server.
+    const WindowDesc& getDesc() const;
+
+    UVec2 getWindowSize() const;
+
   protected:
+    friend class EventQueue;
+
     Display* display = nullptr;
     XLibWindow window;
+
+    WindowDesc mDesc;
 };
 }
@@ -0,0 +1,209 @@
+#include "Test.h"
+
+#include "CrossWindow/Common/EventLanes.h"
+#include "CrossWindow/Common/EventMailbox.h"
+
+#include <vector>
+
+/**
+ * Checks the order events come out of EventLanes in each drain order, in
+ * particular that input split across the Normal and Low lanes keeps its
+ * relative order, also when motion is coalesced at capacity, and that
+ * posting to a mailbox while it drains is safe.
+ */
+using namespace xwin;
+
+namespace
+{
+const ModifierState sNoModifiers(false, false, false, false);
+
+Event press()
+{
+    return Event(
+        MouseInputData(MouseInput::Left, ButtonState::Pressed, sNoModifiers));
+}
+
+Event release()
+{
+    return Event(
+        MouseInputData(MouseInput::Left, ButtonState::Released, sNoModifiers));
+}
+
+Event move(unsigned x)
+{
+    return Event(MouseMoveData(x, 0, x, 0, 1, 0));
+}
+
+// Push press, motion, release, a Close and more motion.
+void pushDrag(EventLanes& lanes)
+{
+    lanes.push(press());
+    lanes.push(move(1));
+    lanes.push(move(2));
+    lanes.push(release());
+    lanes.push(Event(EventType::Close));
+    lanes.push(move(3));
+}
+
+std::vector<EventType> drain(EventLanes& lanes)
+{
+    std::vector<EventType> types;
+    while (!lanes.empty())
+    {
+        types.push_back(lanes.front().type);
+        lanes.pop();
+    }
+    return types;
+}
+
+void testArrival()
+{
+    EventLanes lanes;
+    pushDrag(lanes);
+    std::vector<EventType> expected = {
+        EventType::MouseInput, EventType::MouseMove, EventType::MouseMove,
+        EventType::MouseInput, EventType::Close,     EventType::MouseMove};
+    XWIN_CHECK(drain(lanes) == expected);
+}
+
+void testPriority()
+{
+    EventLanes lanes;
+    lanes.setDrainOrder(DrainOrder::Priority);
+    pushDrag(lanes);
+
+    // The Close jumps ahead, the drag itself stays in order.
+    std::vector<EventType> expected = {
+        EventType::Close,      EventType::MouseInput, EventType::MouseMove,
+        EventType::MouseMove,  EventType::MouseInput, EventType::MouseMove};
+    XWIN_CHECK(drain(lanes) == expected);
+
+    // Events pushed while draining still come out by lane and arrival.
+    lanes.push(move(4));
+    lanes.push(press());
+    XWIN_CHECK(lanes.front().type == EventType::MouseMove);
+    lanes.push(Event(EventType::Close));
+    XWIN_CHECK(lanes.front().type == EventType::Close);
+    lanes.pop();
+    XWIN_CHECK(lanes.front().type == EventType::MouseMove);
+    lanes.pop();
+    XWIN_CHECK(lanes.front().type == EventType::MouseInput);
+    lanes.pop();
+    XWIN_CHECK(lanes.empty());
+}
+
+void testReassigned()
+{
+    EventLanes lanes;
+    lanes.setDrainOrder(DrainOrder::Priority);
+    lanes.setPriority(EventType::MouseInput, EventPriority::High);
+    pushDrag(lanes);
+
+    std::vector<EventType> expected = {
+        EventType::MouseInput, EventType::MouseInput, EventType::Close,
+        EventType::MouseMove,  EventType::MouseMove,  EventType::MouseMove};
+    XWIN_CHECK(drain(lanes) == expected);
+}
+
+void testMotionOrder()
+{
+    // Motion keeps its own order whichever lane it's read through.
+    EventLanes lanes;
+    lanes.setDrainOrder(DrainOrder::Priority);
+    for (unsigned x = 0; x < 100; ++x)
+    {
+        lanes.push(x % 10 == 0 ? press() : move(x));
+    }
+    unsigned last = 0;
+    bool ordered = true;
+    while (!lanes.empty())
+    {
+        if (lanes.front().type == EventType::MouseMove)
+        {
+            ordered = ordered && lanes.front().data.mouseMove.x > last;
+            last = lanes.front().data.mouseMove.x;
+        }
+        lanes.pop();
+    }
+    XWIN_CHECK(ordered);
+}
+
+void testCoalesceOrder()
+{
+    // Motion after a press at capacity can't be merged into the motion
+    // before the press, that would report the pointer moving before the
+    // click. The older motion is dropped instead.
+    EventLanes lanes;
+    lanes.setCapacity(2);
+    lanes.push(move(1));
+    lanes.push(press());
+    lanes.push(move(2));
+    XWIN_CHECK(lanes.size() == 2);
+    XWIN_CHECK(lanes.getDropCount(EventType::MouseMove) == 1);
+    XWIN_CHECK(lanes.getCoalesceCount(EventType::MouseMove) == 0);
+
+    // Motion right after motion still merges.
+    lanes.push(move(3));
+    XWIN_CHECK(lanes.getCoalesceCount(EventType::MouseMove) == 1);
+
+    XWIN_CHECK(lanes.front().type == EventType::MouseInput);
+    lanes.pop();
+    XWIN_CHECK(!lanes.empty() && lanes.front().type == EventType::MouseMove &&
+               lanes.front().data.mouseMove.x == 3);
+    lanes.pop();
+    XWIN_CHECK(lanes.empty());
+}
+
+// A pipeline stage that posts another event for each of the first few it
+// sees, as a handler reacting to an event might.
+class RepostStage : public EventProcessor
+{
+  public:
+    RepostStage(EventMailbox& mailbox) : mMailbox(mailbox) {}
+
+    void process(const Event& e, EventSink& sink) override
+    {
+        if (mReposts < 3)
+        {
+            ++mReposts;
+            mMailbox.post(Event(UserData(mReposts)));
+        }
+        sink(e);
+    }
+
+  protected:
+    EventMailbox& mMailbox;
+    unsigned mReposts = 0;
+};
+
+void testMailboxRepost()
+{
+    EventMailbox mailbox;
+    EventLanes lanes;
+    RepostStage stage(mailbox);
+    lanes.setPipeline(&stage);
+
+    // Each drain delivers what was posted before it, posts made while
+    // draining wait for the next one.
+    mailbox.post(Event(UserData(0)));
+    for (unsigned code = 0; code < 4; ++code)
+    {
+        mailbox.drain(lanes);
+        XWIN_CHECK(lanes.size() == 1);
+        XWIN_CHECK(!lanes.empty() && lanes.front().data.user.code == code);
+        drain(lanes);
+    }
+    XWIN_CHECK(!mailbox.hasPosted());
+}
+}
+
+int main()
+{
+    testArrival();
+    testPriority();
+    testReassigned();
+    testMotionOrder();
+    testCoalesceOrder();
+    testMailboxRepost();
+    return test::finish("EventLanes");
+}
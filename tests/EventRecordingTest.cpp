@@ -0,0 +1,373 @@
+#include "Test.h"
+
+#include "CrossWindow/Common/EventRecording.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+/**
+ * Records a session of every event type with a payload, plays it back with
+ * EventPlayback in AsFastAsPossible mode and compares what comes out, then
+ * checks that truncated and corrupt recordings are rejected or cut short
+ * without reading past the end.
+ */
+using namespace xwin;
+
+namespace
+{
+const char* sPath = "crosswindow-recording-test.xwev";
+
+// Windows are only compared by identity, so any distinct addresses will do.
+char sWindowStorage[2];
+Window* const sWindowA = reinterpret_cast<Window*>(&sWindowStorage[0]);
+Window* const sWindowB = reinterpret_cast<Window*>(&sWindowStorage[1]);
+
+typedef std::vector<std::vector<Event>> Frames;
+
+bool sameString(const char* a, const char* b)
+{
+    return a == nullptr || b == nullptr ? a == b : strcmp(a, b) == 0;
+}
+
+bool sameEvent(const Event& a, const Event& b)
+{
+    if (a.type != b.type || a.window != b.window)
+    {
+        return false;
+    }
+    const EventData& x = a.data;
+    const EventData& y = b.data;
+    switch (a.type)
+    {
+    case EventType::Focus:
+        return x.focus.focused == y.focus.focused;
+    case EventType::Resize:
+        return x.resize.width == y.resize.width &&
+               x.resize.height == y.resize.height &&
+               x.resize.resizing == y.resize.resizing;
+    case EventType::DPI:
+        return x.dpi.scale == y.dpi.scale;
+    case EventType::Keyboard:
+        return x.keyboard.key == y.keyboard.key &&
+               x.keyboard.state == y.keyboard.state &&
+               x.keyboard.modifiers.shift == y.keyboard.modifiers.shift &&
+               x.keyboard.modifiers.ctrl == y.keyboard.modifiers.ctrl;
+    case EventType::MouseMove:
+        return x.mouseMove.x == y.mouseMove.x &&
+               x.mouseMove.y == y.mouseMove.y &&
+               x.mouseMove.screenx == y.mouseMove.screenx &&
+               x.mouseMove.screeny == y.mouseMove.screeny &&
+               x.mouseMove.deltax == y.mouseMove.deltax &&
+               x.mouseMove.deltay == y.mouseMove.deltay;
+    case EventType::MouseRaw:
+        return x.mouseRaw.deltax == y.mouseRaw.deltax &&
+               x.mouseRaw.deltay == y.mouseRaw.deltay;
+    case EventType::MouseWheel:
+        return x.mouseWheel.delta == y.mouseWheel.delta &&
+               x.mouseWheel.modifiers.alt == y.mouseWheel.modifiers.alt;
+    case EventType::MouseInput:
+        return x.mouseInput.button == y.mouseInput.button &&
+               x.mouseInput.state == y.mouseInput.state;
+    case EventType::Touch:
+    {
+        if (x.touch.numTouches != y.touch.numTouches)
+        {
+            return false;
+        }
+        for (unsigned i = 0; i < x.touch.numTouches; ++i)
+        {
+            const TouchPoint& p = x.touch.touches[i];
+            const TouchPoint& q = y.touch.touches[i];
+            if (p.id != q.id || p.screenX != q.screenX ||
+                p.screenY != q.screenY || p.clientX != q.clientX ||
+                p.clientY != q.clientY || p.isChanged != q.isChanged)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    case EventType::Gamepad:
+    {
+        const GamepadData& g = x.gamepad;
+        const GamepadData& h = y.gamepad;
+        if (g.connected != h.connected || g.index != h.index ||
+            !sameString(g.id, h.id) || !sameString(g.mapping, h.mapping) ||
+            g.numAxes != h.numAxes || g.numButtons != h.numButtons)
+        {
+            return false;
+        }
+        for (unsigned i = 0; i < g.numAxes; ++i)
+        {
+            if (g.axis[i] != h.axis[i])
+            {
+                return false;
+            }
+        }
+        for (unsigned i = 0; i < g.numButtons; ++i)
+        {
+            if (g.analogButton[i] != h.analogButton[i] ||
+                g.digitalButton[i] != h.digitalButton[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    case EventType::Timer:
+        return x.timer.id == y.timer.id &&
+               x.timer.expirations == y.timer.expirations;
+    case EventType::FdReady:
+        return x.fdReady.id == y.fdReady.id && x.fdReady.fd == y.fdReady.fd &&
+               x.fdReady.readable == y.fdReady.readable &&
+               x.fdReady.writable == y.fdReady.writable &&
+               x.fdReady.hangup == y.fdReady.hangup;
+    case EventType::User:
+        return x.user.code == y.user.code &&
+               x.user.payload[0] == y.user.payload[0] &&
+               x.user.payload[1] == y.user.payload[1];
+    default:
+        return true;
+    }
+}
+
+Frames makeSession()
+{
+    Frames frames(4);
+
+    frames[0].push_back(Event(EventType::Create, sWindowA));
+    frames[0].push_back(Event(ResizeData(1280, 720, false), sWindowA));
+    frames[0].push_back(Event(FocusData(true), sWindowA));
+    frames[0].push_back(Event(DpiData(1.5f), sWindowA));
+
+    ModifierState shift(false, false, true, false);
+    frames[1].push_back(
+        Event(KeyboardData(Key::A, ButtonState::Pressed, shift), sWindowA));
+    frames[1].push_back(Event(MouseMoveData(10, 20, 110, 220, 10, 20), sWindowA));
+    frames[1].push_back(Event(MouseMoveData(8, 25, 108, 225, -2, 5), sWindowA));
+    frames[1].push_back(Event(MouseRawData(-3, 7), sWindowA));
+    frames[1].push_back(
+        Event(MouseWheelData(-1.25, ModifierState(false, true, false, false)),
+              sWindowA));
+    frames[1].push_back(Event(
+        MouseInputData(MouseInput::Left, ButtonState::Released, shift),
+        sWindowA));
+
+    // A second window, and a frame with nothing in it.
+    frames[2].push_back(Event(EventType::Create, sWindowB));
+    frames[2].push_back(Event(ResizeData(640, 480, true), sWindowB));
+
+    TouchData touch = {};
+    touch.numTouches = 2;
+    touch.touches[0] = {7, 100, 200, 10, 20, true};
+    touch.touches[1] = {9, 300, 400, 30, 40, false};
+    frames[3].push_back(Event(touch, sWindowB));
+
+    GamepadData gamepad = {};
+    gamepad.connected = true;
+    gamepad.index = 1;
+    gamepad.id = "Test Pad";
+    gamepad.mapping = nullptr;
+    gamepad.numAxes = 3;
+    gamepad.axis[0] = -1.0;
+    gamepad.axis[1] = 0.25;
+    gamepad.axis[2] = 1.0;
+    gamepad.numButtons = 10;
+    gamepad.analogButton[9] = 0.5;
+    gamepad.digitalButton[0] = true;
+    gamepad.digitalButton[9] = true;
+    frames[3].push_back(Event(gamepad, sWindowB));
+
+    frames[3].push_back(Event(TimerData(3, 2)));
+    frames[3].push_back(Event(FdReadyData(4, 17, true, false, true)));
+    frames[3].push_back(Event(UserData(42, 1ull << 40, 5), sWindowA));
+    frames[3].push_back(Event(EventType::Close, sWindowA));
+    return frames;
+}
+
+bool record(const Frames& frames)
+{
+    EventRecorder recorder;
+    if (!recorder.open(sPath))
+    {
+        return false;
+    }
+    uint64_t timestamp = 0;
+    for (const std::vector<Event>& frame : frames)
+    {
+        for (const Event& e : frame)
+        {
+            recorder.record(e, timestamp);
+            timestamp += 1000;
+        }
+        recorder.markFrame(timestamp);
+    }
+    recorder.close();
+    return true;
+}
+
+std::vector<uint8_t> readFile(const char* path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)),
+                                std::istreambuf_iterator<char>());
+}
+
+// Play a loaded recording one frame per update. maxFrames bounds a broken
+// reader that never finishes.
+Frames play(EventPlayback& playback, size_t maxFrames)
+{
+    playback.setMode(EventPlayback::Mode::AsFastAsPossible);
+    playback.setWindow(1, sWindowA);
+    playback.setWindow(2, sWindowB);
+
+    Frames frames;
+    while (!playback.finished() && frames.size() < maxFrames)
+    {
+        playback.beginUpdate();
+        frames.push_back(std::vector<Event>());
+        Event e;
+        while (playback.poll(e))
+        {
+            frames.back().push_back(e);
+        }
+    }
+    return frames;
+}
+
+std::vector<Event> flatten(const Frames& frames)
+{
+    std::vector<Event> events;
+    for (const std::vector<Event>& frame : frames)
+    {
+        events.insert(events.end(), frame.begin(), frame.end());
+    }
+    return events;
+}
+
+void testRoundTrip(const Frames& session, const std::vector<uint8_t>& data)
+{
+    EventPlayback playback;
+    XWIN_CHECK(playback.open(sPath));
+    Frames played = play(playback, 64);
+    XWIN_CHECK(playback.finished());
+
+    // The End marker is read by one more update after the last frame.
+    XWIN_CHECK(played.size() >= session.size());
+    for (size_t f = 0; f < session.size() && f < played.size(); ++f)
+    {
+        XWIN_CHECK(played[f].size() == session[f].size());
+        for (size_t i = 0; i < session[f].size() && i < played[f].size(); ++i)
+        {
+            if (!XWIN_CHECK(sameEvent(played[f][i], session[f][i])))
+            {
+                printf("  frame %zu event %zu, type %zu\n", f, i,
+                       static_cast<size_t>(session[f][i].type));
+            }
+        }
+    }
+    for (size_t f = session.size(); f < played.size(); ++f)
+    {
+        XWIN_CHECK(played[f].empty());
+    }
+
+    // Loading from memory and restarting play the same events again.
+    EventPlayback memory;
+    XWIN_CHECK(memory.open(data.data(), data.size()));
+    play(memory, 64);
+    memory.restart();
+    XWIN_CHECK(flatten(play(memory, 64)).size() == flatten(session).size());
+}
+
+void testTruncated(const Frames& session, const std::vector<uint8_t>& data)
+{
+    std::vector<Event> expected = flatten(session);
+    size_t previous = 0;
+    for (size_t size = 0; size < data.size(); ++size)
+    {
+        EventPlayback playback;
+        if (!playback.open(data.data(), size))
+        {
+            // Only a cut inside the header can be rejected up front.
+            XWIN_CHECK(size < 8);
+            continue;
+        }
+        std::vector<Event> events = flatten(play(playback, 64));
+        XWIN_CHECK(playback.finished());
+
+        // A cut recording plays a prefix of the session that only grows as
+        // more of it is kept.
+        XWIN_CHECK(events.size() <= expected.size());
+        XWIN_CHECK(events.size() >= previous);
+        previous = events.size();
+        for (size_t i = 0; i < events.size() && i < expected.size(); ++i)
+        {
+            XWIN_CHECK(sameEvent(events[i], expected[i]));
+        }
+    }
+}
+
+void testCorrupt(const std::vector<uint8_t>& data)
+{
+    // Bad headers are rejected.
+    std::vector<uint8_t> badMagic = data;
+    badMagic[0] = 'Y';
+    EventPlayback playback;
+    XWIN_CHECK(!playback.open(badMagic.data(), badMagic.size()));
+    XWIN_CHECK(playback.finished());
+
+    std::vector<uint8_t> badVersion = data;
+    badVersion[4] = 0;
+    badVersion[5] = 0;
+    XWIN_CHECK(!playback.open(badVersion.data(), badVersion.size()));
+
+    badVersion[4] = static_cast<uint8_t>(EventRecorder::Version + 1);
+    XWIN_CHECK(!playback.open(badVersion.data(), badVersion.size()));
+
+    // An unknown tag ends playback where it's found.
+    std::vector<uint8_t> badTag = data;
+    badTag[8] = 0x80;
+    XWIN_CHECK(playback.open(badTag.data(), badTag.size()));
+    XWIN_CHECK(flatten(play(playback, 64)).empty());
+    XWIN_CHECK(playback.finished());
+
+    // Flipped bytes anywhere after the header must never hang or read out of
+    // bounds, whatever they decode to.
+    uint32_t seed = 12345;
+    for (unsigned round = 0; round < 2000; ++round)
+    {
+        std::vector<uint8_t> corrupt = data;
+        for (unsigned flips = 0; flips < 1 + round % 4; ++flips)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            size_t at = 8 + (seed >> 8) % (corrupt.size() - 8);
+            corrupt[at] ^= static_cast<uint8_t>(1u << (seed % 8));
+        }
+        EventPlayback corrupted;
+        XWIN_CHECK(corrupted.open(corrupt.data(), corrupt.size()));
+        play(corrupted, corrupt.size() + 1);
+        XWIN_CHECK(corrupted.finished());
+    }
+}
+}
+
+int main()
+{
+    Frames session = makeSession();
+    if (!XWIN_CHECK(record(session)))
+    {
+        return test::finish("EventRecording");
+    }
+    std::vector<uint8_t> data = readFile(sPath);
+    XWIN_CHECK(data.size() > 8);
+
+    testRoundTrip(session, data);
+    testTruncated(session, data);
+    testCorrupt(data);
+
+    remove(sPath);
+    return test::finish("EventRecording");
+}
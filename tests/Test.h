@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdio.h>
+
+/**
+ * The few helpers CrossWindow's tests share. Each test is its own executable
+ * registered with CTest, returning non zero if any check failed.
+ */
+namespace xwin
+{
+namespace test
+{
+inline unsigned& getFailureCount()
+{
+    static unsigned failures = 0;
+    return failures;
+}
+
+inline bool check(bool passed, const char* expression, const char* file,
+                  int line)
+{
+    if (!passed)
+    {
+        printf("%s:%d: check failed: %s\n", file, line, expression);
+        ++getFailureCount();
+    }
+    return passed;
+}
+
+// Print a summary and return the process exit code.
+inline int finish(const char* name)
+{
+    unsigned failures = getFailureCount();
+    printf("%s: %s (%u failed)\n", name, failures == 0 ? "passed" : "FAILED",
+           failures);
+    return failures == 0 ? 0 : 1;
+}
+}
+}
+
+#define XWIN_CHECK(expression)                                                 \
+    ::xwin::test::check((expression), #expression, __FILE__, __LINE__)